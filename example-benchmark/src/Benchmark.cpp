@@ -0,0 +1,213 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+
+//--------------------------------------------------------------
+void Report::section(const std::string& title){
+    this->addLine("");
+    this->addLine("== " + title);
+}
+
+void Report::add(const std::string& label, double value, const std::string& unit){
+    this->addLine("  " + label + " : " + ofToString(value, 2) + " " + unit);
+}
+
+void Report::note(const std::string& text){
+    this->addLine("  (" + text + ")");
+}
+
+std::vector<std::string> Report::getLines() const{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->lines;
+}
+
+void Report::addLine(const std::string& line){
+    ofLogNotice("benchmark") << line;
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->lines.push_back(line);
+}
+
+const std::vector<Benchmark>& getBenchmarks(){
+    static const std::vector<Benchmark> benchmarks = {
+        { "loading", &benchmarkLoading },
+        { "attributeNames", &benchmarkAttributeNames },
+        { "arrays", &benchmarkArrays },
+        { "batchLoader", &benchmarkBatchLoader },
+        { "recordSet", &benchmarkRecordSet },
+        { "memoryPool", &benchmarkMemoryPool },
+        { "nodeReader", &benchmarkNodeReader },
+        { "hashing", &benchmarkHashing },
+        { "frozen", &benchmarkFrozen },
+        { "diff", &benchmarkDiff },
+        { "paths", &benchmarkPaths },
+        { "snapshot", &benchmarkSnapshot },
+        { "shared", &benchmarkShared },
+        { "mirror", &benchmarkMirror },
+    };
+    return benchmarks;
+}
+
+
+//--------------------------------------------------------------
+// Every block starts with a header holding its size (16 bytes keep the alignment of malloc)
+namespace {
+    constexpr std::size_t headerSize = 16;
+
+    thread_local std::size_t numAllocations = 0;
+    thread_local std::int64_t currentBytes = 0;
+    thread_local std::int64_t peakBytes = 0;
+
+    void* countedAllocate(std::size_t size){
+        void* block = std::malloc(size + headerSize);
+        if(block == nullptr) return nullptr;
+        *static_cast<std::size_t*>(block) = size;
+        ++numAllocations;
+        currentBytes += static_cast<std::int64_t>(size);
+        if(currentBytes > peakBytes) peakBytes = currentBytes;
+        return static_cast<char*>(block) + headerSize;
+    }
+
+    void countedDeallocate(void* pointer){
+        if(pointer == nullptr) return;
+        void* block = static_cast<char*>(pointer) - headerSize;
+        // Blocks can be freed by another thread than the one that allocated them
+        currentBytes -= static_cast<std::int64_t>(*static_cast<std::size_t*>(block));
+        std::free(block);
+    }
+}
+
+void* operator new(std::size_t size){
+    if(void* pointer = countedAllocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept {
+    countedDeallocate(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept {
+    countedDeallocate(pointer);
+}
+
+namespace memory {
+    void install(){
+        pugi::set_memory_management_functions(&countedAllocate, &countedDeallocate);
+    }
+    std::size_t getNumAllocations(){
+        return numAllocations;
+    }
+    std::int64_t getCurrentBytes(){
+        return currentBytes;
+    }
+    std::int64_t getPeakBytes(){
+        return peakBytes;
+    }
+    void resetPeak(){
+        peakBytes = currentBytes;
+    }
+    std::size_t getPeakResidentBytes(){
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return counters.PeakWorkingSetSize;
+#else
+        struct rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+    }
+}
+
+
+//--------------------------------------------------------------
+namespace data {
+    std::string getPath(const std::string& name){
+        return "benchmark/" + name;
+    }
+
+    bool writeFile(const std::string& name, const std::string& content){
+        ofDirectory::createDirectory(ofFilePath::getEnclosingDirectory(getPath(name), false), true, true);
+        std::ofstream file(ofToDataPath(getPath(name)), std::ios::binary);
+        file.write(content.data(), content.size());
+        return file.good();
+    }
+
+    std::string makeRecords(std::size_t targetBytes){
+        std::string xml;
+        xml.reserve(targetBytes + 1024);
+        xml += "<?xml version=\"1.0\"?>\n<records>\n";
+        for(std::size_t i = 0; xml.size() < targetBytes; ++i){
+            xml += "  <record id=\"" + ofToString(i) + "\" time=\"" + ofToString(i * 0.04) + "\">";
+            xml += "<name>record " + ofToString(i) + "</name>";
+            xml += "<position x=\"" + ofToString(i % 640) + ".5\" y=\"" + ofToString(i % 480) + ".25\" z=\"0\"/>";
+            xml += "<value>" + ofToString((i * 7919) % 1000) + "</value>";
+            xml += "</record>\n";
+        }
+        xml += "</records>\n";
+        return xml;
+    }
+
+    void makeScene(pugi::xml_node parent, std::size_t numNodes, int depth){
+        // Breadth per level so that depth levels hold about numNodes nodes
+        const std::size_t breadth = std::max<std::size_t>(2, static_cast<std::size_t>(std::pow(double(numNodes), 1.0 / depth) + 0.5));
+        std::size_t counter = 0;
+        std::function<void(pugi::xml_node, int)> fill = [&](pugi::xml_node node, int level){
+            for(std::size_t i = 0; i < breadth && counter < numNodes; ++i){
+                const bool isMesh = (counter % 16) == 0;
+                pugi::xml_node child = node.append_child(isMesh ? "mesh" : (level + 1 < depth ? "group" : "layer"));
+                child.append_attribute("id").set_value(static_cast<unsigned int>(counter));
+                child.append_attribute("x").set_value(static_cast<float>(counter % 100) * 0.5f);
+                ++counter;
+                if(level + 1 < depth) fill(child, level + 1);
+                else child.text().set(static_cast<unsigned int>(counter));
+            }
+        };
+        fill(parent, 0);
+    }
+}
@@ -0,0 +1,113 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxPugiXML.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+
+// Benchmark results, collected from the benchmark thread and displayed by the app
+class Report {
+public:
+    void section(const std::string& title);
+    void add(const std::string& label, double value, const std::string& unit);
+    void note(const std::string& text);
+
+    std::vector<std::string> getLines() const;
+
+protected:
+    void addLine(const std::string& line);
+
+    mutable std::mutex mutex;
+    std::vector<std::string> lines;
+};
+
+
+struct Benchmark {
+    const char* name;
+    void (*run)(Report& report);
+};
+
+// All benchmarks, in running order. Each one generates its data in bin/data/benchmark/.
+const std::vector<Benchmark>& getBenchmarks();
+
+
+// Best of `repeats` runs, in milliseconds
+template<typename FUNCTION>
+double measureMs(FUNCTION&& function, int repeats = 5){
+    double best = 0;
+    for(int i = 0; i < repeats; ++i){
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(i == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+// Heap accounting, per thread : the app replaces the global operator new / delete and pugixml's allocation functions.
+// Both count here, so a measured block sees every allocation it makes, but none of the drawing thread's.
+namespace memory {
+    void install(); // before anything allocates with pugixml
+    std::size_t getNumAllocations();
+    std::int64_t getCurrentBytes();
+    std::int64_t getPeakBytes();
+    void resetPeak(); // peak = current
+    // Whole process
+    std::size_t getPeakResidentBytes();
+}
+
+// Synthetic data
+namespace data {
+    // Relative to the data folder
+    std::string getPath(const std::string& name);
+    bool writeFile(const std::string& name, const std::string& content);
+    // A flat document : <records><record id="0" time="0.5"><name>...</name><position x="" y="" z=""/>...</record>...</records>
+    std::string makeRecords(std::size_t targetBytes);
+    // A scene graph of about numNodes elements, `depth` levels deep, with a few named `mesh`
+    void makeScene(pugi::xml_node parent, std::size_t numNodes, int depth = 6);
+}
+
+// Benchmarks
+void benchmarkLoading(Report& report);
+void benchmarkAttributeNames(Report& report);
+void benchmarkArrays(Report& report);
+void benchmarkBatchLoader(Report& report);
+void benchmarkRecordSet(Report& report);
+void benchmarkMemoryPool(Report& report);
+void benchmarkNodeReader(Report& report);
+void benchmarkHashing(Report& report);
+void benchmarkFrozen(Report& report);
+void benchmarkDiff(Report& report);
+void benchmarkPaths(Report& report);
+void benchmarkSnapshot(Report& report);
+void benchmarkShared(Report& report);
+void benchmarkMirror(Report& report);
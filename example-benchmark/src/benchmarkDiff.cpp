@@ -0,0 +1,105 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+namespace {
+    struct SizeWriter : public pugi::xml_writer {
+        std::size_t size = 0;
+        void write(const void*, size_t _size) override { size += _size; }
+    };
+    std::size_t getSerializedSize(const pugi::xml_node& node){
+        SizeWriter writer;
+        node.print(writer, "", pugi::format_raw);
+        return writer.size;
+    }
+}
+
+
+// Diffing 10MB documents with a few edits, and the patch size against shipping the whole file.
+void benchmarkDiff(Report& report){
+    pugi::xml_document from;
+    if(!from.load_string(data::makeRecords(10 << 20).c_str())){
+        report.note("couldn't parse the records");
+        return;
+    }
+    pugi::xml_document to;
+    to.reset(from);
+
+    // A few scattered edits : changed attributes and text, a moved, an inserted and a removed record
+    pugi::xml_node records = to.child("records");
+    std::vector<pugi::xml_node> all;
+    for(pugi::xml_node record = records.child("record"); record; record = record.next_sibling("record")) all.push_back(record);
+    for(std::size_t i = 0; i < 10; ++i){
+        pugi::xml_node record = all[(i * 7919) % all.size()];
+        record.attribute("time").set_value(-1.f);
+        record.child("value").text().set(static_cast<int>(i));
+    }
+    records.insert_move_after(all[all.size() / 3], all[all.size() / 2]);
+    records.insert_copy_before(all[10], all[all.size() / 4]).attribute("id").set_value("inserted");
+    records.remove_child(all[all.size() - 2]);
+
+    report.section("Diff of " + ofToString(all.size()) + " records (" + ofToString(getSerializedSize(from) / 1024) + " KB), 13 edits");
+
+    std::size_t numOperations = 0;
+    ofxPugiXml::DiffStats stats;
+    pugi::xml_document patch;
+    const double diffMs = measureMs([&](){
+        patch.reset();
+        numOperations = ofxPugiXml::diff(from, to, patch, &stats);
+    });
+    report.add("diff", diffMs, "ms");
+    report.add("  hashing", stats.hashMs, "ms");
+    report.add("  comparing", stats.diffMs, "ms");
+    report.add("operations", static_cast<double>(numOperations), "");
+    report.add("nodes compared", static_cast<double>(stats.numNodesCompared), "");
+    report.add("patch size", static_cast<double>(getSerializedSize(patch)), "bytes");
+
+    pugi::xml_document target;
+    bool applied = true;
+    const double patchMs = measureMs([&](){
+        target.reset(from);
+        applied = ofxPugiXml::patch(target, patch) && applied;
+    }, 3);
+    report.add("copy + patch", patchMs, "ms");
+    if(!applied || ofxPugiXml::hashNode(target) != ofxPugiXml::hashNode(to)) report.note("the patched document differs");
+
+    // Many moves in one big node : positions are tracked in O(log n) per operation
+    pugi::xml_document reversed;
+    reversed.append_child("records");
+    for(std::size_t i = all.size() > 20000 ? all.size() - 20000 : 0; i < all.size(); ++i){
+        if(all[i].parent()) reversed.first_child().prepend_copy(all[i]);
+    }
+    pugi::xml_document inOrder;
+    inOrder.append_child("records");
+    for(pugi::xml_node record = reversed.first_child().last_child(); record; record = record.previous_sibling()) inOrder.first_child().append_copy(record);
+    const double reversedMs = measureMs([&](){
+        patch.reset();
+        numOperations = ofxPugiXml::diff(inOrder, reversed, patch);
+    }, 3);
+    report.add("diff, " + ofToString(numOperations) + " moves", reversedMs, "ms");
+}
@@ -0,0 +1,94 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+// Traversals and searches on a frozen copy, against the live DOM.
+void benchmarkFrozen(Report& report){
+    const std::size_t numNodes = 2000000;
+    pugi::xml_document doc;
+    data::makeScene(doc.append_child("scene"), numNodes);
+
+    report.section("Frozen document, " + ofToString(numNodes) + " nodes");
+
+    ofxPugiXml::FrozenDocument frozen;
+    report.add("freeze", measureMs([&](){ frozen.freeze(doc); }, 1), "ms");
+    report.add("frozen memory", frozen.getMemoryUsage() / double(1 << 20), "MB");
+
+    // Full traversal, reading an attribute of every element
+    double domSum = 0, frozenSum = 0;
+    const double domTraversalMs = measureMs([&](){
+        domSum = 0;
+        pugi::xml_node node = doc.first_child();
+        while(node){
+            if(node.type() == pugi::node_element) domSum += node.attribute("x").as_float();
+            // Depth first, in document order
+            if(node.first_child()) node = node.first_child();
+            else {
+                while(node && !node.next_sibling()) node = node.parent();
+                if(node) node = node.next_sibling();
+            }
+        }
+    }, 3);
+    const std::uint32_t xId = frozen.getNameId("x");
+    const double frozenTraversalMs = measureMs([&](){
+        frozenSum = 0;
+        for(ofxPugiXml::FrozenNode node : frozen.getRoot().descendants()){
+            if(node.type() != pugi::node_element) continue;
+            float x = 0;
+            if(const char* value = node.attribute(xId)) ofxPugiXml::frozen::parseValue(value, x);
+            frozenSum += x;
+        }
+    }, 3);
+    report.add("DOM traversal", domTraversalMs, "ms");
+    report.add("frozen traversal", frozenTraversalMs, "ms");
+    if(domSum != frozenSum) report.note("traversals disagree");
+
+    // Searching all the meshes
+    std::vector<pugi::xml_node> domMeshes;
+    const double domSearchMs = measureMs([&](){
+        domMeshes.clear();
+        struct Finder : public pugi::xml_tree_walker {
+            std::vector<pugi::xml_node>* results;
+            bool for_each(pugi::xml_node& node) override {
+                if(std::strcmp(node.name(), "mesh") == 0) results->push_back(node);
+                return true;
+            }
+        } finder;
+        finder.results = &domMeshes;
+        doc.traverse(finder);
+    }, 3);
+    std::vector<ofxPugiXml::FrozenNode> frozenMeshes;
+    const std::uint32_t meshId = frozen.getNameId("mesh");
+    const double frozenSearchMs = measureMs([&](){
+        frozenMeshes.clear();
+        frozen.findAll(frozen.getRoot(), meshId, frozenMeshes);
+    }, 3);
+    report.add("DOM search (" + ofToString(domMeshes.size()) + " meshes)", domSearchMs, "ms");
+    report.add("frozen findAll", frozenSearchMs, "ms");
+    if(domMeshes.size() != frozenMeshes.size()) report.note("searches disagree");
+}
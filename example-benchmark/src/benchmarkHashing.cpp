@@ -0,0 +1,75 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+namespace {
+    struct StringWriter : public pugi::xml_writer {
+        std::string text;
+        void write(const void* _data, size_t _size) override { text.append(static_cast<const char*>(_data), _size); }
+    };
+    std::string serialize(const pugi::xml_node& node){
+        StringWriter writer;
+        node.print(writer, "", pugi::format_raw);
+        return writer.text;
+    }
+}
+
+
+// "Has this subtree changed ?" with memoized hashes, against serialize-and-compare.
+void benchmarkHashing(Report& report){
+    const std::size_t numNodes = 100000;
+    pugi::xml_document doc;
+    pugi::xml_node scene = doc.append_child("scene");
+    data::makeScene(scene, numNodes);
+    pugi::xml_node leaf = scene;
+    while(leaf.first_child().type() == pugi::node_element) leaf = leaf.first_child();
+
+    report.section("Change detection on a " + ofToString(numNodes) + " nodes subtree");
+
+    std::string previous = serialize(scene);
+    bool changed = false;
+    const double serializeMs = measureMs([&](){ changed = (serialize(scene) != previous) || changed; });
+    report.add("serialize and compare", serializeMs, "ms");
+
+    const double hashMs = measureMs([&](){ ofxPugiXml::hashNode(scene); });
+    report.add("hashNode (uncached)", hashMs, "ms");
+
+    ofxPugiXml::HashCache cache;
+    const std::uint64_t hash = cache.getHash(scene);
+    const double cachedMs = measureMs([&](){ changed = (cache.getHash(scene) != hash) || changed; });
+    report.add("HashCache, unchanged", cachedMs * 1000., "us");
+
+    // One leaf changes : only its ancestors are hashed again
+    const double modifiedMs = measureMs([&](){
+        leaf.attribute("x").set_value(leaf.attribute("x").as_float() + 1.f);
+        cache.invalidate(leaf);
+        changed = (cache.getHash(scene) != hash) || changed;
+    });
+    report.add("HashCache, one leaf modified", modifiedMs * 1000., "us");
+    if(!changed) report.note("the modification wasn't detected");
+}
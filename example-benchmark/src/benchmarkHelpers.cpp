@@ -0,0 +1,151 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+// Composing component names (position_x, position_y...) with AttrName instead of formatAttrName().
+void benchmarkAttributeNames(Report& report){
+    const int numCalls = 100000;
+    pugi::xml_document doc;
+    pugi::xml_node node = doc.append_child("state");
+    const glm::vec4 position(1.f, 2.f, 3.f, 4.f);
+    const ofFloatColor color(.1f, .2f, .3f, 1.f);
+    // Attributes exist : only the lookups and conversions are measured
+    ofxPugiXml::setNodeAttribute(node, "position", position);
+    ofxPugiXml::setNodeAttribute(node, "color", color);
+
+    report.section("Component attribute names, " + ofToString(numCalls) + " calls");
+
+    // What the specialisations did before
+    auto setWithFormat = [&](const char* name, const glm::vec4& value){
+        node.attribute(ofxPugiXml::formatAttrName(name, "x").c_str()).set_value(value.x);
+        node.attribute(ofxPugiXml::formatAttrName(name, "y").c_str()).set_value(value.y);
+        node.attribute(ofxPugiXml::formatAttrName(name, "z").c_str()).set_value(value.z);
+        node.attribute(ofxPugiXml::formatAttrName(name, "w").c_str()).set_value(value.w);
+    };
+
+    auto measure = [&](const std::string& label, const std::function<void()>& call){
+        const std::size_t allocations = memory::getNumAllocations();
+        const double ms = measureMs([&](){ for(int i = 0; i < numCalls; ++i) call(); }, 1);
+        report.add(label + " allocations per call", double(memory::getNumAllocations() - allocations) / numCalls, "");
+        report.add(label + " time per call", ms * 1e6 / numCalls, "ns");
+    };
+
+    measure("formatAttrName vec4 set", [&](){ setWithFormat("position", position); });
+    measure("setNodeAttribute vec4", [&](){ ofxPugiXml::setNodeAttribute(node, "position", position); });
+    measure("setNodeAttribute ofFloatColor", [&](){ ofxPugiXml::setNodeAttribute(node, "color", color); });
+    glm::vec4 readPosition;
+    measure("getNodeAttributeValue vec4", [&](){ ofxPugiXml::getNodeAttributeValue(node, "position", readPosition); });
+    report.note("a base name longer than 56 chars allocates once per call");
+}
+
+
+// One text node per array against one <v value=""/> child per number.
+void benchmarkArrays(Report& report){
+    const std::size_t numValues = 1000000;
+    std::vector<float> values(numValues);
+    for(std::size_t i = 0; i < numValues; ++i) values[i] = std::sin(i * 0.001f) * 100.f;
+
+    report.section("Arrays of " + ofToString(numValues) + " floats");
+
+    pugi::xml_document arrayDoc;
+    pugi::xml_node arrayNode = arrayDoc.append_child("curve");
+    const double arrayWriteMs = measureMs([&](){ ofxPugiXml::setNodeArray(arrayNode, values); }, 3);
+    const double arrayBytes = std::strlen(arrayNode.text().get());
+    std::vector<float> readValues;
+    const double arrayReadMs = measureMs([&](){ ofxPugiXml::getNodeArray(arrayNode, readValues); }, 3);
+
+    pugi::xml_document attributeDoc;
+    pugi::xml_node attributeNode;
+    const double attributeWriteMs = measureMs([&](){
+        attributeNode = attributeDoc.append_child("curve");
+        for(float value : values) attributeNode.append_child("v").append_attribute("value").set_value(value);
+    }, 1);
+    double attributeBytes = 0;
+    for(pugi::xml_node v : attributeNode.children()) attributeBytes += std::strlen(v.attribute("value").value());
+    const double attributeReadMs = measureMs([&](){
+        readValues.clear();
+        for(pugi::xml_node v : attributeNode.children()) readValues.push_back(v.attribute("value").as_float());
+    }, 3);
+
+    // Serialized size
+    struct CountingWriter : public pugi::xml_writer {
+        std::size_t size = 0;
+        void write(const void*, size_t _size) override { size += _size; }
+    };
+    CountingWriter arrayFile, attributeFile;
+    arrayDoc.save(arrayFile, "", pugi::format_raw);
+    attributeDoc.save(attributeFile, "", pugi::format_raw);
+
+    report.add("setNodeArray", arrayBytes / (1 << 20) * 1000. / arrayWriteMs, "MB/s of number text");
+    report.add("one attribute per value, write", attributeBytes / (1 << 20) * 1000. / attributeWriteMs, "MB/s of number text");
+    report.add("getNodeArray", arrayBytes / (1 << 20) * 1000. / arrayReadMs, "MB/s of number text");
+    report.add("one attribute per value, read", attributeBytes / (1 << 20) * 1000. / attributeReadMs, "MB/s of number text");
+    report.add("setNodeArray file size", arrayFile.size / double(1 << 20), "MB");
+    report.add("one attribute per value file size", attributeFile.size / double(1 << 20), "MB");
+    if(readValues != values) report.note("arrays didn't round-trip exactly");
+}
+
+
+// Reading the named children of a wide node, in order.
+void benchmarkNodeReader(Report& report){
+    const int numChildren = 200;
+    const int numReads = 2000;
+    pugi::xml_document doc;
+    pugi::xml_node node = doc.append_child("preset");
+    std::vector<std::string> names;
+    for(int i = 0; i < numChildren; ++i){
+        names.push_back("parameter" + ofToString(i));
+        node.append_child(names.back().c_str()).append_attribute("value").set_value(i);
+    }
+
+    report.section("Reading " + ofToString(numChildren) + " children in order, " + ofToString(numReads) + " times");
+
+    int sum = 0;
+    const double childMs = measureMs([&](){
+        for(int read = 0; read < numReads; ++read){
+            for(const std::string& name : names){
+                int value = 0;
+                ofxPugiXml::getNodeValueFromAttribute(node, name.c_str(), value);
+                sum += value;
+            }
+        }
+    }, 3);
+    const double readerMs = measureMs([&](){
+        for(int read = 0; read < numReads; ++read){
+            ofxPugiXml::NodeReader reader(node);
+            for(const std::string& name : names){
+                int value = 0;
+                reader.getValueFromAttribute(name.c_str(), value);
+                sum += value;
+            }
+        }
+    }, 3);
+    report.add("getNodeValueFromAttribute per child", childMs * 1e6 / (numReads * numChildren), "ns");
+    report.add("NodeReader per child", readerMs * 1e6 / (numReads * numChildren), "ns");
+    if(sum == 0) report.note("no values read");
+}
@@ -0,0 +1,110 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+// In-place and memory-mapped loading against the plain ofBufferFromFile() + getText() + load_string() path.
+void benchmarkLoading(Report& report){
+    const std::size_t fileSize = 100 << 20;
+    const std::string name = "loading.xml";
+    data::writeFile(name, data::makeRecords(fileSize));
+    const std::string path = data::getPath(name);
+
+    report.section("Loading a " + ofToString(fileSize >> 20) + " MB file");
+    report.note("heap peak : bytes allocated on top of what was live before the load, document included");
+
+    pugi::xml_document doc;
+    std::shared_ptr<ofxPugiXml::MappedFile> mapping;
+
+    auto measure = [&](const std::string& label, const std::function<bool()>& load){
+        doc.reset();
+        mapping.reset();
+        memory::resetPeak();
+        const std::int64_t before = memory::getCurrentBytes();
+        bool success = true;
+        const double ms = measureMs([&](){ success = load() && success; }, 3);
+        report.add(label + " time", ms, "ms");
+        report.add(label + " heap peak", (memory::getPeakBytes() - before) / double(fileSize), "x file size");
+        if(!success) report.note(label + " failed");
+    };
+
+    measure("load_string", [&](){
+        std::string buffer = ofBufferFromFile(path).getText();
+        return bool(doc.load_string(buffer.c_str()));
+    });
+    measure("loadFileInPlace", [&](){
+        return bool(ofxPugiXml::loadFileInPlace(doc, path));
+    });
+    measure("loadFileMapped", [&](){
+        return bool(ofxPugiXml::loadFileMapped(doc, mapping, path));
+    });
+    report.note("loadFileMapped's heap peak excludes the mapping itself, which the OS pages in and out");
+}
+
+
+// Reloading a settings document over and over, with the allocator installed by the app against ofxPugiXml::MemoryPool.
+void benchmarkMemoryPool(Report& report){
+    const std::size_t fileSize = 5 << 20;
+    const int numReloads = 50;
+    const std::string name = "reloading.xml";
+    data::writeFile(name, data::makeRecords(fileSize));
+    const std::string path = data::getPath(name);
+
+    report.section("Reloading a " + ofToString(fileSize >> 20) + " MB file " + ofToString(numReloads) + " times");
+
+    // Like ofxPugiXmlSettings::loadFile()
+    pugi::xml_document doc;
+    bool success = true;
+    auto reload = [&](){
+        for(int i = 0; i < numReloads; ++i) success = ofxPugiXml::loadFileInPlace(doc, path) && success;
+    };
+
+    const std::size_t allocations = memory::getNumAllocations();
+    const double defaultMs = measureMs(reload, 1);
+    report.add("default allocator, time per reload", defaultMs / numReloads, "ms");
+    report.add("default allocator, allocations per reload", double(memory::getNumAllocations() - allocations) / numReloads, "");
+
+    // The pool can't free blocks of the counting allocator : none may be in use
+    doc.reset();
+    if(!ofxPugiXml::MemoryPool::install()){
+        report.note("MemoryPool::install() failed");
+        return;
+    }
+    reload(); // warm up
+    const ofxPugiXml::MemoryPool::Stats before = ofxPugiXml::MemoryPool::getStats();
+    const double poolMs = measureMs(reload, 1);
+    const ofxPugiXml::MemoryPool::Stats after = ofxPugiXml::MemoryPool::getStats();
+    report.add("MemoryPool, time per reload", poolMs / numReloads, "ms");
+    report.add("MemoryPool, mallocs per reload", double((after.numAllocations - before.numAllocations) - (after.numReused - before.numReused)) / numReloads, "");
+    report.add("MemoryPool, allocations served from the cache", 100. * (after.numReused - before.numReused) / std::max<std::size_t>(1, after.numAllocations - before.numAllocations), "%");
+    report.add("MemoryPool, reserved", after.reserved / double(1 << 20), "MB");
+    report.add("MemoryPool, high water", after.highWater / double(1 << 20), "MB");
+
+    doc.reset();
+    if(!ofxPugiXml::MemoryPool::uninstall()) report.note("MemoryPool::uninstall() failed");
+    if(!success) report.note("loading failed");
+}
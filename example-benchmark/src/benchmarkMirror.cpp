@@ -0,0 +1,89 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+#include <atomic>
+#include <thread>
+
+
+// Parameter mirror handles read by many threads while one thread writes them and another flushes.
+void benchmarkMirror(Report& report){
+    const int numReaders = std::max(2, int(std::thread::hardware_concurrency()) - 2);
+    const auto duration = std::chrono::seconds(3);
+
+    ofxPugiXmlSharedSettings shared;
+    ofxPugiXmlParameterMirror mirror;
+    ofxPugiXmlParameterMirror::Handle<float> opacity = mirror.bind("scene/layer[3]/opacity", 1.f);
+    ofxPugiXmlParameterMirror::Handle<glm::vec4> position = mirror.bind("scene/layer[3]/position", glm::vec4(0.f));
+    mirror.flush(shared);
+
+    report.section("Parameter mirror : " + ofToString(numReaders) + " readers, 1 writer, 1 flusher, " + ofToString(duration.count()) + " s");
+
+    std::atomic<bool> done(false);
+    std::atomic<std::uint64_t> numReads(0);
+    std::atomic<std::uint64_t> numInvalid(0);
+    std::vector<std::thread> readers;
+    for(int i = 0; i < numReaders; ++i){
+        readers.emplace_back([&](){
+            std::uint64_t reads = 0;
+            while(!done){
+                // The writer sets all 4 components to the same value, and positive opacities
+                const glm::vec4 value = position.get();
+                if(value.x != value.y || value.y != value.z || value.z != value.w) numInvalid++;
+                if(opacity.get() < 0.f) numInvalid++;
+                reads += 2;
+            }
+            numReads += reads;
+        });
+    }
+    std::atomic<std::uint64_t> numFlushes(0);
+    std::thread flusher([&](){
+        while(!done){
+            mirror.flush(shared);
+            numFlushes++;
+        }
+    });
+
+    std::uint64_t numWrites = 0;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while(std::chrono::steady_clock::now() < end){
+        for(int i = 0; i < 1000; ++i, ++numWrites){
+            const float value = float(numWrites % 100000);
+            position = glm::vec4(value);
+            opacity = value / 100000.f;
+        }
+    }
+    done = true;
+    for(std::thread& reader : readers) reader.join();
+    flusher.join();
+
+    const double seconds = double(duration.count());
+    report.add("writes (vec4 + float)", numWrites / seconds / 1e6, "M/s");
+    report.add("reads, all readers", numReads / seconds / 1e6, "M/s");
+    report.add("flushes", numFlushes / seconds, "/s");
+    if(numInvalid > 0) report.note(ofToString(numInvalid.load()) + " torn or invalid reads");
+}
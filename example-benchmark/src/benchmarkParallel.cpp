@@ -0,0 +1,90 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+// Files/s for a synthetic corpus of small presets, against one ofxPugiXmlSettings::loadFile() per file.
+void benchmarkBatchLoader(Report& report){
+    const std::size_t numFiles = 3000;
+    std::vector<std::string> paths;
+    for(std::size_t i = 0; i < numFiles; ++i){
+        const std::string name = "corpus/preset" + ofToString(i) + ".xml";
+        data::writeFile(name, data::makeRecords(2048 + (i % 7) * 1024));
+        paths.push_back(data::getPath(name));
+    }
+
+    report.section("Loading " + ofToString(numFiles) + " small files");
+
+    const double sequentialMs = measureMs([&](){
+        for(const std::string& path : paths){
+            ofxPugiXmlSettings settings;
+            settings.loadFile(path);
+        }
+    }, 1);
+    report.add("ofxPugiXmlSettings::loadFile, one by one", numFiles * 1000. / sequentialMs, "files/s");
+
+    ofxPugiXmlBatchLoader loader;
+    for(unsigned int numThreads : { 1u, 2u, 4u, 8u }){
+        loader.setNumThreads(numThreads);
+        std::size_t numFailed = 0;
+        const double ms = measureMs([&](){ numFailed = loader.load(paths).size() == numFiles ? loader.getStats().numFailed : numFiles; }, 3);
+        report.add("ofxPugiXmlBatchLoader, " + ofToString(numThreads) + " threads", numFiles * 1000. / ms, "files/s");
+        if(numFailed > 0) report.note(ofToString(numFailed) + " files failed");
+    }
+    report.note("the files are in the OS cache after the first run");
+}
+
+
+// Parsing one flat document split in records, against a single-threaded load_buffer().
+void benchmarkRecordSet(Report& report){
+    const std::size_t fileSize = 256 << 20;
+    const std::string xml = data::makeRecords(fileSize);
+    const double megabytes = xml.size() / double(1 << 20);
+
+    report.section("Parsing a " + ofToString(int(megabytes)) + " MB flat document");
+
+    pugi::xml_document doc;
+    const double singleMs = measureMs([&](){ doc.load_buffer(xml.data(), xml.size()); }, 3);
+    report.add("load_buffer", megabytes * 1000. / singleMs, "MB/s");
+    doc.reset();
+
+    std::string copy;
+    for(unsigned int numThreads : { 1u, 2u, 4u, 8u }){
+        ofxPugiXmlRecordSet records;
+        records.setNumThreads(numThreads);
+        double ms = 0;
+        for(int i = 0; i < 3; ++i){
+            // The parse is in-place : start from a fresh copy, outside of the measure
+            records.clear();
+            copy = xml;
+            const double runMs = measureMs([&](){ records.loadBufferInPlace(&copy[0], copy.size()); }, 1);
+            if(i == 0 || runMs < ms) ms = runMs;
+        }
+        report.add("ofxPugiXmlRecordSet, " + ofToString(numThreads) + " threads", megabytes * 1000. / ms, "MB/s");
+        if(!records.getStats().parallel) report.note("not split, parsed on one thread");
+    }
+}
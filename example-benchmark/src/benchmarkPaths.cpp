@@ -0,0 +1,83 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+// Compiled paths against pushTag / getValue / popTag, for values read every frame.
+void benchmarkPaths(Report& report){
+    const int numLayers = 16;
+    const int numFrames = 10000;
+    ofxPugiXmlSettings settings;
+    settings.addTag("scene");
+    settings.pushTag("scene");
+    for(int i = 0; i < numLayers; ++i){
+        settings.addTag("layer");
+        settings.pushTag("layer", i);
+        settings.setValue("opacity", 1. / (i + 1));
+        settings.popTag();
+    }
+    settings.setValue("time", 0.);
+    settings.popTag();
+
+    std::vector<ofxPugiXmlSettings::Path<float>> paths;
+    for(int i = 0; i < numLayers; ++i) paths.push_back(settings.compilePath("scene/layer[" + ofToString(i) + "]/opacity", 1.f));
+
+    report.section("Reading " + ofToString(numLayers) + " layer opacities, " + ofToString(numFrames) + " frames");
+
+    double sum = 0;
+    const double pushTagMs = measureMs([&](){
+        for(int frame = 0; frame < numFrames; ++frame){
+            for(int i = 0; i < numLayers; ++i){
+                settings.pushTag("scene");
+                settings.pushTag("layer", i);
+                sum += settings.getValue("opacity", 1.);
+                settings.popTag();
+                settings.popTag();
+            }
+        }
+    }, 3);
+    report.add("pushTag / getValue / popTag, per frame", pushTagMs * 1000. / numFrames, "us");
+
+    const double pathMs = measureMs([&](){
+        for(int frame = 0; frame < numFrames; ++frame){
+            for(ofxPugiXmlSettings::Path<float>& path : paths) sum += path.get();
+        }
+    }, 3);
+    report.add("compiled paths, per frame", pathMs * 1000. / numFrames, "us");
+
+    // The generation is per document : any change makes every handle resolve and decode again
+    const double modifiedMs = measureMs([&](){
+        for(int frame = 0; frame < numFrames; ++frame){
+            settings.pushTag("scene");
+            settings.setValue("time", frame * 0.016);
+            settings.popTag();
+            for(ofxPugiXmlSettings::Path<float>& path : paths) sum += path.get();
+        }
+    }, 3);
+    report.add("compiled paths + one unrelated change, per frame", modifiedMs * 1000. / numFrames, "us");
+    if(sum == 0) report.note("nothing was read");
+}
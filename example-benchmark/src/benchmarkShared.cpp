@@ -0,0 +1,116 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+#include <atomic>
+#include <thread>
+
+
+// Many readers refreshing and reading while one writer commits, checking every read is consistent.
+void benchmarkShared(Report& report){
+    const int numReaders = std::max(2, int(std::thread::hardware_concurrency()) - 1);
+    const auto duration = std::chrono::seconds(3);
+
+    ofxPugiXmlSharedSettings shared;
+    {
+        pugi::xml_document doc;
+        pugi::xml_node audio = doc.append_child("audio");
+        audio.append_child("gain").text().set(0);
+        audio.append_child("count").text().set(0);
+        data::makeScene(doc.append_child("scene"), 10000);
+        shared.publish(doc);
+    }
+
+    report.section("Shared settings : " + ofToString(numReaders) + " readers, 1 writer, " + ofToString(duration.count()) + " s");
+
+    std::atomic<bool> done(false);
+    std::atomic<std::uint64_t> numReads(0);
+    std::atomic<std::uint64_t> numRefreshes(0);
+    std::atomic<std::uint64_t> numInconsistent(0);
+    std::atomic<std::uint64_t> worstRefreshNs(0);
+    std::vector<std::thread> readers;
+    for(int i = 0; i < numReaders; ++i){
+        readers.emplace_back([&](){
+            ofxPugiXmlSharedSettings::ReadSession session = shared.read();
+            std::uint64_t reads = 0;
+            std::uint64_t refreshes = 0;
+            std::uint64_t worstNs = 0;
+            int lastGain = 0;
+            while(!done){
+                const auto start = std::chrono::steady_clock::now();
+                if(session.refresh()) refreshes++;
+                const std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                worstNs = std::max(worstNs, ns);
+                // Both values are written in the same commit
+                if(session.pushTag("audio")){
+                    const int gain = session.getValue("gain", -1);
+                    if(gain != session.getValue("count", -2) || gain < lastGain) numInconsistent++;
+                    lastGain = gain;
+                    session.popTag();
+                }
+                else numInconsistent++;
+                reads++;
+            }
+            numReads += reads;
+            numRefreshes += refreshes;
+            std::uint64_t worst = worstRefreshNs.load();
+            while(worstNs > worst && !worstRefreshNs.compare_exchange_weak(worst, worstNs)){}
+        });
+    }
+
+    // The writer copies the 10000 nodes document on every commit
+    int numCommits = 0;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while(std::chrono::steady_clock::now() < end){
+        ofxPugiXmlSharedSettings::WriterSession writer = shared.write();
+        writer.pushTag("audio");
+        const int gain = writer.getValue("gain", 0) + 1;
+        writer.setValue("gain", gain);
+        writer.setValue("count", gain);
+        writer.commit();
+        numCommits++;
+    }
+    done = true;
+    for(std::thread& reader : readers) reader.join();
+    shared.collect();
+
+    const double seconds = double(duration.count());
+    report.add("commits", numCommits / seconds, "/s");
+    report.add("reads, all readers", numReads / seconds / 1e6, "M/s");
+    report.add("refreshes that changed version", double(numRefreshes.load()), "");
+    report.add("worst refresh", worstRefreshNs / 1000., "us");
+    if(numInconsistent > 0) report.note(ofToString(numInconsistent.load()) + " inconsistent reads");
+
+    // Taking a reference outside of a session, uncontended
+    const int numVersions = 1000000;
+    std::size_t numNodes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < numVersions; ++i) numNodes += shared.getVersion()->first_child().empty() ? 0 : 1;
+    const double versionNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / double(numVersions);
+    report.add("getVersion()", versionNs, "ns");
+    if(numNodes != std::size_t(numVersions)) report.note("empty version");
+}
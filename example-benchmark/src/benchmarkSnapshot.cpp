@@ -0,0 +1,82 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Benchmark.h"
+
+
+namespace {
+    // Visits every node of the mapped view, reading names and values
+    std::size_t walk(const ofxPugiXml::Snapshot& snapshot){
+        std::size_t numBytes = 0;
+        std::vector<ofxPugiXml::Snapshot::Node> stack(1, snapshot.getRoot());
+        while(!stack.empty()){
+            const ofxPugiXml::Snapshot::Node node = stack.back();
+            stack.pop_back();
+            numBytes += std::strlen(node.name()) + std::strlen(node.value());
+            for(ofxPugiXml::Snapshot::Node child = node.firstChild(); child; child = child.nextSibling()) stack.push_back(child);
+        }
+        return numBytes;
+    }
+}
+
+
+// Rebuilding a document from a snapshot against parsing the file, from 1 to 100 MB.
+// (Add 1 << 30 to the sizes for 1 GB : the peak memory is about 10 times the file size.)
+void benchmarkSnapshot(Report& report){
+    for(std::size_t fileSize : { std::size_t(1) << 20, std::size_t(10) << 20, std::size_t(100) << 20 }){
+        const std::string name = "snapshot" + ofToString(fileSize >> 20) + ".xml";
+        data::writeFile(name, data::makeRecords(fileSize));
+        const std::string path = data::getPath(name);
+
+        report.section("Snapshot of a " + ofToString(fileSize >> 20) + " MB file");
+
+        pugi::xml_document doc;
+        bool success = true;
+        const double parseMs = measureMs([&](){ success = bool(ofxPugiXml::loadFileInPlace(doc, path)) && success; }, 3);
+        report.add("loadFileInPlace", parseMs, "ms");
+
+        const double saveMs = measureMs([&](){ success = ofxPugiXml::Snapshot::save(doc, path + ".snapshot", path) && success; }, 1);
+        report.add("Snapshot::save", saveMs, "ms");
+        doc.reset();
+
+        ofxPugiXml::Snapshot snapshot;
+        const double rebuildMs = measureMs([&](){
+            success = snapshot.open(path + ".snapshot") && snapshot.isValidFor(path) && snapshot.toDocument(doc) && success;
+            snapshot.close();
+        }, 3);
+        report.add("open + isValidFor + toDocument", rebuildMs, "ms");
+
+        std::size_t numBytes = 0;
+        const double viewMs = measureMs([&](){
+            success = snapshot.open(path + ".snapshot") && success;
+            numBytes = walk(snapshot);
+            snapshot.close();
+        }, 3);
+        report.add("open + walking the mapped view", viewMs, "ms");
+        if(!success || numBytes == 0) report.note("a step failed");
+    }
+    report.note("toDocument() parses the raw image in place : a win only if it beats loadFileInPlace here");
+}
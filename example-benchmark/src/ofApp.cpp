@@ -0,0 +1,70 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofApp.h"
+
+
+ofApp::ofApp(const std::vector<std::string>& _names) : names(_names)
+{
+
+}
+
+
+void ofApp::setup()
+{
+    ofSetFrameRate(30);
+
+    runner = std::thread([this](){
+        for(const Benchmark& benchmark : getBenchmarks()){
+            if(!names.empty() && std::find(names.begin(), names.end(), benchmark.name) == names.end()) continue;
+            benchmark.run(report);
+        }
+        report.section("Done");
+        report.add("Peak resident memory", memory::getPeakResidentBytes() / (1024. * 1024.), "MB");
+        done = true;
+    });
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+
+    // Latest lines
+    const std::vector<std::string> lines = report.getLines();
+    const int numVisible = std::max(1, ofGetHeight() / 14 - 2);
+    const std::size_t first = lines.size() > std::size_t(numVisible) ? lines.size() - numVisible : 0;
+    for(std::size_t i = first; i < lines.size(); ++i){
+        ofDrawBitmapString(lines[i], 10, 20 + (i - first) * 14);
+    }
+    if(!done) ofDrawBitmapStringHighlight("Running...", 10, ofGetHeight() - 10);
+}
+
+
+void ofApp::exit()
+{
+    if(runner.joinable()) runner.join();
+}
@@ -0,0 +1,75 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "Tests.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+
+namespace tests {
+    namespace {
+        std::atomic<std::size_t> numFailures{0};
+    }
+
+    void fail(const char* expression, const char* file, int line){
+        numFailures++;
+        std::fprintf(stderr, "%s:%d: check failed : %s\n", file, line, expression);
+    }
+
+    std::size_t getNumFailures(){
+        return numFailures;
+    }
+
+    std::string getPath(const std::string& name){
+        return "tests/" + name;
+    }
+
+    bool writeFile(const std::string& name, const std::string& content){
+        std::ofstream file(ofToDataPath(getPath(name)), std::ios::binary | std::ios::trunc);
+        file << content;
+        return bool(file);
+    }
+
+    bool fileExists(const std::string& name){
+        return ofFile::doesFileExist(getPath(name));
+    }
+
+    void removeFile(const std::string& name){
+        ofFile::removeFile(getPath(name));
+    }
+}
+
+
+const std::vector<Test>& getTests(){
+    static const std::vector<Test> allTests = {
+        { "journal", &testJournal },
+        { "hashing", &testHashing },
+        { "frozen", &testFrozen },
+        { "snapshot", &testSnapshot },
+        { "shared", &testSharedSettings },
+    };
+    return allTests;
+}
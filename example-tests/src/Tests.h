@@ -0,0 +1,62 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxPugiXML.h"
+#include <string>
+#include <vector>
+
+
+// Checks count the failures and print the failed expression, the test goes on.
+#define CHECK(expression) ((expression) ? (void)0 : tests::fail(#expression, __FILE__, __LINE__))
+
+namespace tests {
+    void fail(const char* expression, const char* file, int line);
+    std::size_t getNumFailures();
+
+    // Relative to the data folder, in bin/data/tests/
+    std::string getPath(const std::string& name);
+    bool writeFile(const std::string& name, const std::string& content);
+    bool fileExists(const std::string& name);
+    void removeFile(const std::string& name);
+}
+
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+// All tests, in running order
+const std::vector<Test>& getTests();
+
+void testJournal();
+void testHashing();
+void testFrozen();
+void testSharedSettings();
+void testSnapshot();
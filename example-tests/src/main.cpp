@@ -0,0 +1,48 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "Tests.h"
+
+
+// Usage : example-tests [test names...], runs all tests by default. Returns 1 if a check failed.
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> names;
+	for(int i = 1; i < argc; ++i) names.push_back(argv[i]);
+
+	ofDirectory::createDirectory(tests::getPath(""), true, true);
+	for(const Test& test : getTests()){
+		if(!names.empty() && std::find(names.begin(), names.end(), test.name) == names.end()) continue;
+		const std::size_t failuresBefore = tests::getNumFailures();
+		test.run();
+		ofLogNotice("example-tests") << test.name << (tests::getNumFailures() == failuresBefore ? " : ok" : " : FAILED");
+	}
+	if(tests::getNumFailures() > 0){
+		ofLogError("example-tests") << tests::getNumFailures() << " checks failed";
+		return 1;
+	}
+	ofLogNotice("example-tests") << "all checks passed";
+	return 0;
+}
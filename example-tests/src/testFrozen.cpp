@@ -0,0 +1,79 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "Tests.h"
+#include <climits>
+
+
+namespace {
+    template<typename TYPE>
+    TYPE parse(const char* text){
+        TYPE value = TYPE();
+        ofxPugiXml::frozen::parseValue(text, value);
+        return value;
+    }
+}
+
+// Frozen values convert like pugi's as_*(), a missing attribute leaves the value untouched
+void testFrozen(){
+    CHECK(parse<int>("") == 0);
+    CHECK(parse<int>("010") == 10);
+    CHECK(parse<int>("0x1F") == 31);
+    CHECK(parse<int>(" -42") == -42);
+    CHECK(parse<int>("99999999999") == INT_MAX);
+    CHECK(parse<int>("-99999999999") == INT_MIN);
+    CHECK(parse<int>("2147483648") == INT_MAX);
+    CHECK(parse<int>("-2147483648") == INT_MIN);
+    CHECK(parse<unsigned int>("-5") == 0);
+    CHECK(parse<unsigned int>("0x1FFFFFFFF") == UINT_MAX);
+    CHECK(parse<long long>("-0x10") == -16);
+    CHECK(parse<unsigned long long>("18446744073709551616") == ULLONG_MAX);
+    CHECK(parse<bool>("Yes") == true);
+    CHECK(parse<bool>(" true") == false);
+    CHECK(parse<bool>("") == false);
+    CHECK(parse<float>("") == 0.0f);
+    CHECK(parse<double>(" 2.5") == 2.5);
+
+    pugi::xml_document doc;
+    CHECK(doc.load_string("<mesh x=\"3\" pos_x=\"1\"/>"));
+    ofxPugiXml::FrozenDocument frozen;
+    CHECK(frozen.freeze(doc));
+    ofxPugiXml::FrozenNode mesh = frozen.getRoot().child("mesh");
+    int x = 7;
+    const int defaultValue = 5;
+    CHECK(!ofxPugiXml::getNodeAttributeValue(mesh, "y", x, &defaultValue));
+    CHECK(x == 7);
+    CHECK(ofxPugiXml::getNodeAttributeValue(mesh, "x", x, &defaultValue));
+    CHECK(x == 3);
+    glm::vec2 position(8, 9);
+    CHECK(!ofxPugiXml::getNodeAttributeValue(mesh, "pos", position));
+    CHECK(position.x == 1 && position.y == 9);
+
+    // Same for documents
+    pugi::xml_node node = doc.child("mesh");
+    x = 7;
+    CHECK(!ofxPugiXml::getNodeAttributeValue(node, "y", x, &defaultValue));
+    CHECK(x == 7);
+}
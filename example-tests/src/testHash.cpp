@@ -0,0 +1,52 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "Tests.h"
+
+
+// Formatting doesn't change hashes, content does. Direct edits need markDirty().
+void testHashing(){
+    pugi::xml_document a, b, c;
+    CHECK(a.load_string("<shader name=\"blur\" size=\" 1.5  2 \"><source>  uniform   float x;\n</source></shader>"));
+    CHECK(b.load_string("<shader size=\"1.5 2\" name=\"blur\">\n\t<source>uniform float x;</source>\n</shader>", pugi::parse_default | pugi::parse_ws_pcdata));
+    CHECK(c.load_string("<shader name=\"blur\" size=\"1.5 3\"><source>uniform float x;</source></shader>"));
+    CHECK(ofxPugiXml::hashNode(a.first_child()) == ofxPugiXml::hashNode(b.first_child()));
+    CHECK(ofxPugiXml::hashNode(a.first_child()) != ofxPugiXml::hashNode(c.first_child()));
+    CHECK(ofxPugiXml::hashNode(pugi::xml_node()) == 0);
+
+    CHECK(tests::writeFile("hashing.xml", "<shader size=\"1\"/>"));
+    ofxPugiXmlSettings settings;
+    CHECK(settings.loadFile(tests::getPath("hashing.xml")));
+    const std::uint64_t before = settings.getHash("shader");
+    settings.setAttribute("shader", "size", 2);
+    const std::uint64_t modified = settings.getHash("shader");
+    CHECK(modified != before);
+
+    // Behind the settings' back : the memoized hash is stale until markDirty()
+    settings.compilePath<int>("shader").getNode().attribute("size").set_value(3);
+    CHECK(settings.getHash("shader") == modified);
+    settings.markDirty();
+    CHECK(settings.getHash("shader") != modified);
+}
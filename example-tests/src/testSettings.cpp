@@ -0,0 +1,83 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "Tests.h"
+
+
+// A file edited behind the journal's back wins over it, and later journaled saves apply to the edited file.
+void testJournal(){
+    const std::string name = "journal.xml";
+    const std::string path = tests::getPath(name);
+    tests::removeFile(name + ".journal");
+
+    // Journals outgrowing half of the file are merged into it
+    const std::string padding = "<padding>" + std::string(1000, '-') + "</padding>\n";
+    CHECK(tests::writeFile(name, "<a value=\"1\"/>\n<b value=\"1\"/>\n" + padding));
+
+    {
+        ofxPugiXmlSettings settings;
+        settings.setUseJournal(true);
+        CHECK(settings.loadFile(path));
+        settings.setAttribute("a", "value", 2);
+        CHECK(settings.saveFile(path));
+        CHECK(tests::fileExists(name + ".journal"));
+    }
+
+    // Edited by hand : different size and modification time, no journal applies to it anymore
+    CHECK(tests::writeFile(name, "<a value=\"1\"/>\n<b value=\"50\"/>\n" + padding));
+
+    {
+        ofxPugiXmlSettings settings;
+        settings.setUseJournal(true);
+        CHECK(settings.loadFile(path));
+        CHECK(settings.getAttribute("a", "value", 0) == 1);
+        CHECK(settings.getAttribute("b", "value", 0) == 50);
+        CHECK(!tests::fileExists(name + ".journal"));
+
+        settings.setAttribute("a", "value", 3);
+        CHECK(settings.saveFile(path));
+        CHECK(tests::fileExists(name + ".journal"));
+    }
+    {
+        ofxPugiXmlSettings settings;
+        settings.setUseJournal(true);
+        CHECK(settings.loadFile(path));
+        CHECK(settings.getAttribute("a", "value", 0) == 3);
+        CHECK(settings.getAttribute("b", "value", 0) == 50);
+
+        // Edited by hand while loaded : the journal no longer matches, the next save rewrites the file
+        CHECK(tests::writeFile(name, "<a value=\"3\"/>\n<b value=\"60\"/>\n" + padding));
+        settings.setAttribute("a", "value", 4);
+        CHECK(settings.saveFile(path));
+        CHECK(!tests::fileExists(name + ".journal"));
+    }
+    {
+        ofxPugiXmlSettings settings;
+        settings.setUseJournal(true);
+        CHECK(settings.loadFile(path));
+        CHECK(settings.getAttribute("a", "value", 0) == 4);
+        CHECK(settings.getAttribute("b", "value", 0) == 50);
+    }
+}
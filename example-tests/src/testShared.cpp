@@ -0,0 +1,100 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Tests.h"
+#include <atomic>
+#include <thread>
+
+
+namespace {
+    // Both attributes are written by the same commit : a reader sees them equal, and never going back
+    void readCounter(ofxPugiXmlSharedSettings& shared, const std::atomic<bool>& stop, std::atomic<int>& numReads){
+        ofxPugiXmlSharedSettings::ReadSession session = shared.read();
+        int last = 0;
+        while(!stop.load()){
+            session.refresh();
+            if(session.pushTag("settings")){
+                const int a = session.getAttribute("counter", "a", -1);
+                const int b = session.getAttribute("counter", "b", -2);
+                CHECK(a == b);
+                CHECK(a >= last);
+                last = a;
+                session.popTag();
+            }
+            else CHECK(false);
+            numReads++;
+        }
+    }
+}
+
+// Readers refresh, short lived sessions and getVersion() race with commits
+void testSharedSettings(){
+    CHECK(tests::writeFile("shared.xml", "<settings><counter a=\"0\" b=\"0\"/></settings>"));
+    ofxPugiXmlSharedSettings shared;
+    CHECK(shared.loadFile(tests::getPath("shared.xml")));
+    std::weak_ptr<const pugi::xml_document> firstVersion = shared.getVersion();
+    const std::uint64_t firstNumber = shared.getVersionNumber();
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> numReads(0);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 3; ++i) threads.emplace_back([&](){ readCounter(shared, stop, numReads); });
+    threads.emplace_back([&](){
+        while(!stop.load()){
+            ofxPugiXmlSharedSettings::Version version = shared.getVersion();
+            pugi::xml_node counter = version->child("settings").child("counter");
+            CHECK(counter.attribute("a").as_int() == counter.attribute("b").as_int());
+            ofxPugiXmlSharedSettings::ReadSession session = shared.read();
+            CHECK(session.getVersion() != nullptr);
+        }
+    });
+
+    const int numCommits = 2000;
+    for(int i = 1; i <= numCommits; ++i){
+        ofxPugiXmlSharedSettings::WriterSession writer = shared.write();
+        CHECK(writer.pushTag("settings"));
+        writer.setAttribute("counter", "a", i);
+        writer.setAttribute("counter", "b", i);
+        // Doesn't wait for the writer session
+        if(i % 500 == 0) CHECK(shared.saveFile(tests::getPath("shared_saved.xml")));
+        writer.commit();
+        if(i % 100 == 0) shared.collect();
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for(std::thread& thread : threads) thread.join();
+
+    CHECK(numReads.load() > 0);
+    CHECK(shared.getVersionNumber() == firstNumber + numCommits);
+    CHECK(shared.getVersion()->child("settings").child("counter").attribute("a").as_int() == numCommits);
+    // Saved from inside the 2000th writer session : the 1999th commit
+    pugi::xml_document saved;
+    CHECK(saved.load_file(ofToDataPath(tests::getPath("shared_saved.xml")).c_str()));
+    CHECK(saved.child("settings").child("counter").attribute("a").as_int() == numCommits - 1);
+    // No session left : everything retired gets freed
+    shared.collect();
+    CHECK(firstVersion.expired());
+}
@@ -0,0 +1,77 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "Tests.h"
+#include <sstream>
+
+
+namespace {
+    std::string print(const pugi::xml_node& node){
+        std::ostringstream stream;
+        node.print(stream, "", pugi::format_raw);
+        return stream.str();
+    }
+}
+
+// toDocument() rebuilds the parsed document, snapshots only match their own file, options and encoding
+void testSnapshot(){
+    const std::string xml = "<?xml version=\"1.0\"?>\n<!-- comment -->\n<scene name=\"a &amp; b\" lines=\"1&#10;2\">\n"
+        "  <layer id=\"1\">text &lt;1&gt;</layer>\n  <layer id=\"2\"><![CDATA[raw <2>]]></layer>\n  <empty/>\n</scene>\n";
+    CHECK(tests::writeFile("snapshot.xml", xml));
+    CHECK(tests::writeFile("snapshot_copy.xml", xml));
+    const std::string path = tests::getPath("snapshot.xml");
+
+    for(unsigned int parseOptions : { pugi::parse_default, pugi::parse_full, pugi::parse_full | pugi::parse_ws_pcdata, pugi::parse_minimal }){
+        pugi::xml_document parsed;
+        CHECK(ofxPugiXml::loadFileInPlace(parsed, path, parseOptions));
+        CHECK(ofxPugiXml::Snapshot::save(parsed, path + ".snapshot", path, parseOptions));
+
+        ofxPugiXml::Snapshot snapshot;
+        CHECK(snapshot.open(path + ".snapshot"));
+        CHECK(snapshot.isValidFor(path, parseOptions));
+        CHECK(!snapshot.isValidFor(path, parseOptions ^ pugi::parse_comments));
+        CHECK(!snapshot.isValidFor(path, parseOptions, pugi::encoding_utf16));
+        CHECK(!snapshot.isValidFor(tests::getPath("snapshot_copy.xml"), parseOptions));
+        pugi::xml_document rebuilt;
+        CHECK(snapshot.toDocument(rebuilt));
+        CHECK(print(rebuilt) == print(parsed));
+        CHECK(ofxPugiXml::hashNode(rebuilt) == ofxPugiXml::hashNode(parsed));
+    }
+
+    // Opt-in : the first load writes the snapshot, the next ones use it until the file changes
+    tests::removeFile("snapshot.xml.snapshot");
+    ofxPugiXmlSettings settings;
+    settings.setUseSnapshot(true);
+    CHECK(settings.loadFile(path));
+    CHECK(tests::fileExists("snapshot.xml.snapshot"));
+    CHECK(settings.loadFile(path));
+    CHECK(settings.getAttribute("scene", "name", std::string()) == "a & b");
+    CHECK(tests::writeFile("snapshot.xml", "<scene name=\"changed\"/>"));
+    CHECK(settings.loadFile(path));
+    CHECK(settings.getAttribute("scene", "name", std::string()) == "changed");
+    ofxPugiXml::Snapshot snapshot;
+    CHECK(snapshot.open(path + ".snapshot") && snapshot.isValidFor(path));
+}
@@ -55,4 +55,23 @@
 
 // Also include our custom OF glue !
 #include "ofxPugiXMLHelpers.h"
+// Only this header brings pugi's names in, the others can be included without it.
+using namespace pugi;
 #include "ofxPugiXMLSettings.h"
+#include "ofxPugiXMLSharedSettings.h"
+#include "ofxPugiXMLParameterMirror.h"
+#include "ofxPugiXMLFileUtils.h"
+#include "ofxPugiXMLWriteSession.h"
+#include "ofxPugiXMLAtom.h"
+#include "ofxPugiXMLStreamReader.h"
+#include "ofxPugiXMLStreamWriter.h"
+#include "ofxPugiXMLXPath.h"
+#include "ofxPugiXMLBatchLoader.h"
+#include "ofxPugiXMLRecordSet.h"
+#include "ofxPugiXMLMemoryPool.h"
+#include "ofxPugiXMLNodeReader.h"
+#include "ofxPugiXMLBinding.h"
+#include "ofxPugiXMLHash.h"
+#include "ofxPugiXMLSnapshot.h"
+#include "ofxPugiXMLFrozen.h"
+#include "ofxPugiXMLDiff.h"
@@ -0,0 +1,100 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofxPugiXMLAtom.h"
+#include "ofxPugiXMLWriteSession.h"
+
+namespace ofxPugiXml {
+
+const std::string& Atom::emptyName(){
+    static const std::string empty;
+    return empty;
+}
+
+//--------------------------------------------------------------
+Atom AtomTable::intern(const char* _name){
+    if(_name == nullptr) _name = "";
+    const std::uint64_t hash = WriteSession::hashName(_name);
+    std::lock_guard<std::mutex> lock(mutex);
+    if(const Atom::Entry* found = findLocked(_name, hash)) return Atom(found);
+
+    Atom::Entry entry;
+    entry.name = _name;
+    entry.hash = hash;
+    entry.id = static_cast<std::uint32_t>(entries.size());
+    entries.push_back(std::move(entry));
+    const Atom::Entry* stored = &entries.back();
+    lookup.emplace(hash, stored);
+    return Atom(stored);
+}
+
+Atom AtomTable::find(const char* _name) const{
+    if(_name == nullptr) _name = "";
+    const std::uint64_t hash = WriteSession::hashName(_name);
+    std::lock_guard<std::mutex> lock(mutex);
+    return Atom(findLocked(_name, hash));
+}
+
+const Atom::Entry* AtomTable::findLocked(const char* _name, std::uint64_t _hash) const{
+    auto range = lookup.equal_range(_hash);
+    for(auto found = range.first; found != range.second; ++found){
+        if(found->second->name == _name) return found->second;
+    }
+    return nullptr;
+}
+
+std::size_t AtomTable::internNames(const pugi::xml_node& _root){
+    const std::size_t before = size();
+    // Iterative pre-order walk, documents can be deeper than the stack
+    pugi::xml_node node = _root;
+    while(node){
+        if(node.type() == pugi::node_element){
+            intern(node.name());
+            for(pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute()) intern(attr.name());
+        }
+        if(node.first_child()){
+            node = node.first_child();
+            continue;
+        }
+        while(node && node != _root && !node.next_sibling()) node = node.parent();
+        if(!node || node == _root) break;
+        node = node.next_sibling();
+    }
+    return size() - before;
+}
+
+std::size_t AtomTable::size() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+AtomTable& getGlobalAtomTable(){
+    // Never destroyed : atoms can be used until the very end (static destructors included)
+    static AtomTable* table = new AtomTable();
+    return *table;
+}
+
+}
@@ -0,0 +1,140 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLWriteSession.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ofxPugiXml {
+
+    class AtomTable;
+
+    // Interned names
+    // An atom is a name registered once in an AtomTable : it carries its length and hash, and two atoms of the same
+    // table are equal if they're the same entry (a pointer comparison). getOrAppendAttribute() and getOrAppendNode()
+    // by atom pass the stored hash to the active WriteSession instead of measuring and hashing the name on every call.
+    // There are no lookups by atom : pugixml doesn't intern the names of its nodes, so finding a child still compares
+    // strings. Searches by name id are what FrozenDocument is for.
+    // Atoms convert to `const char*` and `const std::string&` without allocating, so they can be passed to all helpers
+    // and to the ofxPugiXmlSettings accessors.
+    // Usage :
+    //     static const ofxPugiXml::Atom paramAtom = ofxPugiXml::atom("param");
+    //     static const ofxPugiXml::Atom valueAtom = ofxPugiXml::atom("value");
+    //     ofxPugiXml::WriteSession session;
+    //     for(pugi::xml_node group : root.children()){
+    //         pugi::xml_node param = ofxPugiXml::getOrAppendNode(group, paramAtom);
+    //         ofxPugiXml::getOrAppendAttribute(param, valueAtom).set_value(0.5f);
+    //     }
+    // Note: pugixml owns the names stored in documents, atoms don't change how much memory they use.
+    class Atom {
+    public:
+        Atom(){}
+
+        explicit operator bool() const { return entry != nullptr; }
+        bool operator==(const Atom& _other) const { return entry == _other.entry; }
+        bool operator!=(const Atom& _other) const { return entry != _other.entry; }
+
+        const char* c_str() const { return entry ? entry->name.c_str() : ""; }
+        const std::string& str() const { return entry ? entry->name : emptyName(); }
+        operator const char*() const { return c_str(); }
+        operator const std::string&() const { return str(); }
+
+        std::size_t length() const { return entry ? entry->name.size() : 0; }
+        // Same hash as the WriteSession name tables
+        std::uint64_t getHash() const { return entry ? entry->hash : 0; }
+        // Index in its table, in registration order
+        std::uint32_t getId() const { return entry ? entry->id : 0xffffffff; }
+
+    private:
+        friend class AtomTable;
+        struct Entry {
+            std::string name;
+            std::uint64_t hash;
+            std::uint32_t id;
+        };
+        explicit Atom(const Entry* _entry) : entry(_entry){}
+        static const std::string& emptyName();
+
+        const Entry* entry = nullptr;
+    };
+
+    // A set of atoms, for a document or a whole app. Interning is thread-safe, atoms stay valid as long as their table.
+    class AtomTable {
+    public:
+        AtomTable(){}
+        AtomTable(const AtomTable&) = delete;
+        AtomTable& operator=(const AtomTable&) = delete;
+
+        // Returns the atom of _name, registers it if needed
+        Atom intern(const char* _name);
+        // Returns the atom of _name, or a null atom if it's not registered
+        Atom find(const char* _name) const;
+        // Registers all element and attribute names of a subtree, returns the number of new atoms
+        std::size_t internNames(const pugi::xml_node& _root);
+
+        std::size_t size() const;
+
+    private:
+        const Atom::Entry* findLocked(const char* _name, std::uint64_t _hash) const;
+
+        mutable std::mutex mutex;
+        std::deque<Atom::Entry> entries; // stable addresses
+        std::unordered_multimap<std::uint64_t, const Atom::Entry*> lookup; // by name hash
+    };
+
+    // Atoms of the application-wide table (never destroyed)
+    AtomTable& getGlobalAtomTable();
+    inline Atom atom(const char* _name){ return getGlobalAtomTable().intern(_name); }
+
+    // getOrAppendAttribute() / getOrAppendNode() (see ofxPugiXMLHelpers.h) by atom : a WriteSession gets the stored hash
+    inline pugi::xml_attribute getOrAppendAttribute(pugi::xml_node& _node, const Atom& _attrName){
+#ifdef ofxPugiXML_NODUPLICATES_CHECKS
+        return _node.append_attribute(_attrName.c_str());
+#else
+        if(WriteSession* session = WriteSession::getCurrent()) return session->getOrAppendAttribute(_node, _attrName.c_str(), _attrName.getHash());
+        pugi::xml_attribute attr = _node.attribute(_attrName.c_str());
+        if(!attr) attr = _node.append_attribute(_attrName.c_str());
+        return attr;
+#endif
+    }
+    inline pugi::xml_node getOrAppendNode(pugi::xml_node& _parentNode, const Atom& _nodeName){
+#ifdef ofxPugiXML_NODUPLICATES_CHECKS
+        return _parentNode.append_child(_nodeName.c_str());
+#else
+        if(WriteSession* session = WriteSession::getCurrent()) return session->getOrAppendNode(_parentNode, _nodeName.c_str(), _nodeName.getHash());
+        pugi::xml_node node = _parentNode.child(_nodeName.c_str());
+        if(!node) node = _parentNode.append_child(_nodeName.c_str());
+        return node;
+#endif
+    }
+}
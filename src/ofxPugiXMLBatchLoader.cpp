@@ -0,0 +1,116 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLBatchLoader.h"
+#include "ofxPugiXMLFileUtils.h"
+#include "ofFileUtils.h" // ofDirectory
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <system_error>
+#include <thread>
+
+ofxPugiXmlBatchLoader::ofxPugiXmlBatchLoader(){
+
+}
+
+void ofxPugiXmlBatchLoader::setNumThreads(unsigned int _numThreads){
+    numThreads = _numThreads;
+}
+
+unsigned int ofxPugiXmlBatchLoader::getNumThreads() const {
+    if(numThreads > 0) return numThreads;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ofxPugiXmlBatchLoader::setParseOptions(unsigned int _parseOptions, pugi::xml_encoding _encoding){
+    parseOptions = _parseOptions;
+    encoding = _encoding;
+}
+
+const ofxPugiXmlBatchLoader::Stats& ofxPugiXmlBatchLoader::getStats() const {
+    return stats;
+}
+
+std::vector<ofxPugiXmlBatchLoader::Result> ofxPugiXmlBatchLoader::load(const std::vector<std::string>& paths){
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<Result> results(paths.size());
+    for(std::size_t i = 0; i < paths.size(); ++i){
+        results[i].path = paths[i];
+        results[i].doc.reset(new pugi::xml_document());
+    }
+
+    // Workers pick the next file from a shared cursor until all are taken
+    std::atomic<std::size_t> cursor(0);
+    const unsigned int _parseOptions = parseOptions;
+    const pugi::xml_encoding _encoding = encoding;
+    auto work = [&results, &cursor, _parseOptions, _encoding](){
+        for(std::size_t i = cursor++; i < results.size(); i = cursor++){
+            Result& result = results[i];
+            const auto fileStart = std::chrono::steady_clock::now();
+            result.parseResult = ofxPugiXml::loadFileInPlace(*result.doc, result.path, _parseOptions, _encoding);
+            result.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fileStart).count();
+        }
+    };
+
+    const unsigned int threadCount = (unsigned int)std::max<std::size_t>(1, std::min<std::size_t>(getNumThreads(), results.size()));
+    // The calling thread works too
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    // A thread that can't be started leaves its files to the running ones, which still have to be joined
+    try {
+        for(unsigned int i = 1; i < threadCount; ++i) workers.emplace_back(work);
+    }
+    catch(const std::system_error&){
+    }
+    work();
+    for(std::thread& worker : workers) worker.join();
+
+    stats = Stats();
+    stats.numFiles = results.size();
+    stats.numThreads = (unsigned int)workers.size() + 1;
+    for(const Result& result : results){
+        if(!result.parseResult) stats.numFailed++;
+        stats.sumMs += result.loadMs;
+    }
+    stats.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return results;
+}
+
+std::vector<ofxPugiXmlBatchLoader::Result> ofxPugiXmlBatchLoader::loadDirectory(const std::string& directory, const std::string& extension){
+    ofDirectory dir(directory);
+    if(!extension.empty()) dir.allowExt(extension);
+    dir.listDir();
+    dir.sort();
+
+    std::vector<std::string> paths;
+    paths.reserve(dir.size());
+    for(std::size_t i = 0; i < dir.size(); ++i){
+        paths.push_back(dir.getPath(i));
+    }
+    return load(paths);
+}
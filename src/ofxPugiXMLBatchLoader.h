@@ -0,0 +1,81 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Loads many documents concurrently, one pugi::xml_document per file.
+// Files are handed out one at a time to a pool of worker threads (dynamic scheduling), so a few big files
+// don't leave the other threads idle. Results come back in input order.
+// Usage :
+//     ofxPugiXmlBatchLoader loader;
+//     std::vector<ofxPugiXmlBatchLoader::Result> presets = loader.loadDirectory("presets", "xml");
+//     for(auto& preset : presets) if(preset.parseResult) usePreset(*preset.doc);
+class ofxPugiXmlBatchLoader {
+
+public:
+
+    struct Result {
+        std::string path;
+        std::unique_ptr<pugi::xml_document> doc;
+        pugi::xml_parse_result parseResult;
+        double loadMs = 0; // read + parse
+    };
+
+    struct Stats {
+        std::size_t numFiles = 0;
+        std::size_t numFailed = 0;
+        unsigned int numThreads = 0;
+        double wallMs = 0; // whole batch
+        double sumMs = 0;  // sum of per-file times, sumMs / wallMs is the effective speedup
+        double getFilesPerSecond() const { return wallMs > 0 ? numFiles * 1000.0 / wallMs : 0; }
+    };
+
+    ofxPugiXmlBatchLoader();
+
+    // 0 (default) uses one thread per core
+    void setNumThreads(unsigned int numThreads);
+    unsigned int getNumThreads() const;
+    void setParseOptions(unsigned int parseOptions, pugi::xml_encoding encoding = pugi::encoding_auto);
+
+    // Paths are relative to the data folder. Each file is loaded in-place (see ofxPugiXml::loadFileInPlace).
+    std::vector<Result> load(const std::vector<std::string>& paths);
+    // Loads all files of a directory with the given extension (empty for all files), sorted by path.
+    std::vector<Result> loadDirectory(const std::string& directory, const std::string& extension = "xml");
+
+    // Stats of the last batch
+    const Stats& getStats() const;
+
+protected:
+
+    unsigned int numThreads = 0;
+    unsigned int parseOptions = pugi::parse_default;
+    pugi::xml_encoding encoding = pugi::encoding_auto;
+    Stats stats;
+};
@@ -0,0 +1,288 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "ofxPugiXMLHelpers.h"
+#include "ofxPugiXMLNodeReader.h"
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Struct binding : serialize whole structs with one call.
+// Declare the fields of a type once (at global scope), then save/load it to/from a node :
+//     struct Layer { std::string name; float opacity; glm::vec3 position; ofFloatColor tint; std::vector<float> curve; };
+//     OFXPUGIXML_BIND(Layer, name, opacity, position, tint, curve)
+//     struct Scene { int version; std::vector<Layer> layers; };
+//     OFXPUGIXML_BIND(Scene, version, layers)
+//     ofxPugiXml::save(node, scene);
+//     ofxPugiXml::load(node, scene);
+// Each field is a child node named after it, written like setNodeValueToAttribute() : base types, glm vectors and
+// ofFloatColor reuse the setNodeAttribute() specialisations. Bound types nest, numeric vectors are stored with
+// setNodeArray(), other vectors as `<item>` children.
+// Field names and their lengths are compile-time constants. Loading walks the children once, in document order,
+// trying the field that follows the previous one first : files written by save() match in one comparison per field.
+// Up to 32 fields per type.
+
+namespace ofxPugiXml {
+
+    // A bound member : its (literal) name and pointer
+    template<typename CLASS, typename MEMBER>
+    struct Field {
+        const char* name;
+        std::size_t length;
+        MEMBER CLASS::* member;
+    };
+    template<typename CLASS, typename MEMBER, std::size_t N>
+    constexpr Field<CLASS, MEMBER> makeField(const char (&_name)[N], MEMBER CLASS::* _member){
+        return Field<CLASS, MEMBER>{ _name, N - 1, _member };
+    }
+
+    // Specialised by OFXPUGIXML_BIND()
+    template<typename TYPE>
+    struct Binding {
+        static constexpr bool bound = false;
+    };
+
+    template<typename TYPE>
+    struct IsVector : std::false_type {};
+    template<typename TYPE, typename ALLOC>
+    struct IsVector<std::vector<TYPE, ALLOC> > : std::true_type {};
+
+    // Numbers setNodeArray() / getNodeArray() can convert
+    template<typename TYPE>
+    struct IsArrayNumber : std::integral_constant<bool,
+        std::is_same<TYPE, float>::value || std::is_same<TYPE, double>::value || std::is_same<TYPE, int>::value ||
+        std::is_same<TYPE, unsigned int>::value || std::is_same<TYPE, long long>::value || std::is_same<TYPE, glm::vec3>::value> {};
+
+    template<typename TYPE>
+    bool save(pugi::xml_node& _node, const TYPE& _object);
+    template<typename TYPE>
+    bool load(const pugi::xml_node& _node, TYPE& _object);
+
+    // Writes/reads a single value into/from its node
+    template<typename TYPE>
+    bool writeValue(pugi::xml_node& _node, const TYPE& _value);
+    template<typename TYPE>
+    bool readValue(pugi::xml_node& _node, TYPE& _value);
+
+    namespace binding {
+        // How a value is stored, picked by tag dispatch : bound type, numeric array, `<item>` children or attribute
+        struct BoundTag {};
+        struct ArrayTag {};
+        struct ItemsTag {};
+        struct AttributeTag {};
+
+        template<typename TYPE, bool = IsVector<TYPE>::value>
+        struct VectorKind { typedef AttributeTag type; };
+        template<typename TYPE>
+        struct VectorKind<TYPE, true> { typedef typename std::conditional<IsArrayNumber<typename TYPE::value_type>::value, ArrayTag, ItemsTag>::type type; };
+        template<typename TYPE>
+        struct ValueKind { typedef typename std::conditional<Binding<TYPE>::bound, BoundTag, typename VectorKind<TYPE>::type>::type type; };
+
+        template<typename TYPE>
+        inline bool writeValue(pugi::xml_node& _node, const TYPE& _value, BoundTag){
+            return save(_node, _value);
+        }
+        template<typename TYPE>
+        inline bool writeValue(pugi::xml_node& _node, const TYPE& _value, ArrayTag){
+            return setNodeArray(_node, _value);
+        }
+        template<typename TYPE>
+        inline bool writeValue(pugi::xml_node& _node, const TYPE& _value, ItemsTag){
+            while(pugi::xml_node item = _node.child("item")) _node.remove_child(item);
+            bool ret = true;
+            for(const typename TYPE::value_type& itemValue : _value){
+                pugi::xml_node item = _node.append_child("item");
+                ret &= ofxPugiXml::writeValue(item, itemValue);
+            }
+            return ret;
+        }
+        template<typename TYPE>
+        inline bool writeValue(pugi::xml_node& _node, const TYPE& _value, AttributeTag){
+            return setNodeAttribute(_node, "", _value);
+        }
+
+        template<typename TYPE>
+        inline bool readValue(pugi::xml_node& _node, TYPE& _value, BoundTag){
+            return load(_node, _value);
+        }
+        template<typename TYPE>
+        inline bool readValue(pugi::xml_node& _node, TYPE& _value, ArrayTag){
+            return getNodeArray(_node, _value);
+        }
+        template<typename TYPE>
+        inline bool readValue(pugi::xml_node& _node, TYPE& _value, ItemsTag){
+            _value.clear();
+            bool ret = true;
+            for(pugi::xml_node item = _node.child("item"); item; item = item.next_sibling("item")){
+                _value.emplace_back();
+                ret &= ofxPugiXml::readValue(item, _value.back());
+            }
+            return ret;
+        }
+        template<typename TYPE>
+        inline bool readValue(pugi::xml_node& _node, TYPE& _value, AttributeTag){
+            return getNodeAttributeValue(_node, "", _value);
+        }
+    }
+
+    template<typename TYPE>
+    inline bool writeValue(pugi::xml_node& _node, const TYPE& _value){
+        return binding::writeValue(_node, _value, typename binding::ValueKind<TYPE>::type());
+    }
+
+    template<typename TYPE>
+    inline bool readValue(pugi::xml_node& _node, TYPE& _value){
+        return binding::readValue(_node, _value, typename binding::ValueKind<TYPE>::type());
+    }
+
+    namespace binding {
+        template<typename FIELDS, std::size_t... I>
+        inline std::size_t findField(const FIELDS& _fields, const char* _name, std::size_t _length, std::size_t _index, std::index_sequence<I...>){
+            constexpr std::size_t count = sizeof...(I);
+            const char* names[count] = { std::get<I>(_fields).name... };
+            const std::size_t lengths[count] = { std::get<I>(_fields).length... };
+            // Starting at the expected one, wrapping
+            for(std::size_t i = 0; i < count; ++i, ++_index){
+                if(_index >= count) _index = 0;
+                if(lengths[_index] == _length && std::memcmp(names[_index], _name, _length) == 0) return _index;
+            }
+            return count;
+        }
+
+        // Calls _function with the _index-th field
+        template<typename FIELDS, typename FUNCTION, std::size_t... I>
+        inline void visitField(const FIELDS& _fields, std::size_t _index, FUNCTION&& _function, std::index_sequence<I...>){
+            const int expand[] = { 0, (I == _index ? (_function(std::get<I>(_fields)), 0) : 0)... };
+            (void)expand;
+        }
+
+        template<typename FIELDS, typename FUNCTION, std::size_t... I>
+        inline void forEachField(const FIELDS& _fields, FUNCTION&& _function, std::index_sequence<I...>){
+            const int expand[] = { 0, (_function(std::get<I>(_fields)), 0)... };
+            (void)expand;
+        }
+    }
+
+    // Writes all bound fields as children of _node (updating existing ones)
+    template<typename TYPE>
+    bool save(pugi::xml_node& _node, const TYPE& _object){
+        static_assert(Binding<TYPE>::bound, "Type isn't bound, use OFXPUGIXML_BIND()");
+        if(!_node) return false;
+        constexpr auto fields = Binding<TYPE>::fields();
+        constexpr std::size_t count = std::tuple_size<decltype(fields)>::value;
+
+        bool ret = true;
+        // Fields are expected in order after the previous one, inserted there when missing.
+        // A node without children is filled without any lookup.
+        const bool isEmpty = !_node.first_child();
+        NodeReader reader(_node);
+        binding::forEachField(fields, [&](const auto& _field){
+            pugi::xml_node child = isEmpty ? pugi::xml_node() : reader.child(_field.name);
+            if(!child){
+                const pugi::xml_node& previous = reader.getCursor();
+                child = previous ? _node.insert_child_after(_field.name, previous) : _node.prepend_child(_field.name);
+                reader.setCursor(child);
+            }
+            ret &= writeValue(child, _object.*(_field.member));
+        }, std::make_index_sequence<count>());
+        return ret;
+    }
+
+    // Reads all bound fields from the children of _node, in one pass. Missing fields are left untouched.
+    // Returns false if the node doesn't exist or a value couldn't be read.
+    template<typename TYPE>
+    bool load(const pugi::xml_node& _node, TYPE& _object){
+        static_assert(Binding<TYPE>::bound, "Type isn't bound, use OFXPUGIXML_BIND()");
+        if(!_node) return false;
+        constexpr auto fields = Binding<TYPE>::fields();
+        constexpr std::size_t count = std::tuple_size<decltype(fields)>::value;
+
+        bool ret = true;
+        std::size_t expected = 0;
+        for(pugi::xml_node child = _node.first_child(); child; child = child.next_sibling()){
+            if(child.type() != pugi::node_element) continue;
+            const char* name = child.name();
+            const std::size_t index = binding::findField(fields, name, std::strlen(name), expected, std::make_index_sequence<count>());
+            if(index >= count) continue;
+            binding::visitField(fields, index, [&](const auto& _field){
+                ret &= readValue(child, _object.*(_field.member));
+            }, std::make_index_sequence<count>());
+            expected = index + 1;
+        }
+        return ret;
+    }
+}
+
+// Preprocessor helpers for OFXPUGIXML_BIND (EXPAND is needed by MSVC's traditional preprocessor)
+#define OFXPUGIXML_EXPAND(x) x
+#define OFXPUGIXML_FE_1(M, T, a) M(T, a)
+#define OFXPUGIXML_FE_2(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_1(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_3(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_2(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_4(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_3(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_5(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_4(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_6(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_5(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_7(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_6(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_8(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_7(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_9(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_8(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_10(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_9(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_11(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_10(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_12(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_11(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_13(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_12(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_14(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_13(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_15(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_14(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_16(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_15(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_17(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_16(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_18(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_17(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_19(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_18(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_20(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_19(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_21(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_20(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_22(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_21(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_23(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_22(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_24(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_23(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_25(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_24(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_26(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_25(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_27(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_26(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_28(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_27(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_29(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_28(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_30(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_29(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_31(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_30(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FE_32(M, T, a, ...) M(T, a), OFXPUGIXML_EXPAND(OFXPUGIXML_FE_31(M, T, __VA_ARGS__))
+#define OFXPUGIXML_GET_FE(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+#define OFXPUGIXML_FOR_EACH(M, T, ...) OFXPUGIXML_EXPAND(OFXPUGIXML_GET_FE(__VA_ARGS__, OFXPUGIXML_FE_32, OFXPUGIXML_FE_31, OFXPUGIXML_FE_30, OFXPUGIXML_FE_29, OFXPUGIXML_FE_28, OFXPUGIXML_FE_27, OFXPUGIXML_FE_26, OFXPUGIXML_FE_25, OFXPUGIXML_FE_24, OFXPUGIXML_FE_23, OFXPUGIXML_FE_22, OFXPUGIXML_FE_21, OFXPUGIXML_FE_20, OFXPUGIXML_FE_19, OFXPUGIXML_FE_18, OFXPUGIXML_FE_17, OFXPUGIXML_FE_16, OFXPUGIXML_FE_15, OFXPUGIXML_FE_14, OFXPUGIXML_FE_13, OFXPUGIXML_FE_12, OFXPUGIXML_FE_11, OFXPUGIXML_FE_10, OFXPUGIXML_FE_9, OFXPUGIXML_FE_8, OFXPUGIXML_FE_7, OFXPUGIXML_FE_6, OFXPUGIXML_FE_5, OFXPUGIXML_FE_4, OFXPUGIXML_FE_3, OFXPUGIXML_FE_2, OFXPUGIXML_FE_1)(M, T, __VA_ARGS__))
+#define OFXPUGIXML_FIELD(T, FIELD) ::ofxPugiXml::makeField(#FIELD, &T::FIELD)
+
+// Binds the listed fields of TYPE. Use at global scope, after the type's definition.
+#define OFXPUGIXML_BIND(TYPE, ...) \
+    namespace ofxPugiXml { \
+        template<> \
+        struct Binding<TYPE> { \
+            static constexpr bool bound = true; \
+            static constexpr auto fields(){ return std::make_tuple(OFXPUGIXML_FOR_EACH(OFXPUGIXML_FIELD, TYPE, __VA_ARGS__)); } \
+        }; \
+    }
@@ -0,0 +1,362 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLDiff.h"
+#include "ofxPugiXMLHash.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ofxPugiXml {
+
+namespace {
+
+    inline bool isSameKind(const pugi::xml_node& a, const pugi::xml_node& b){
+        return a.type() == b.type() && std::strcmp(a.name(), b.name()) == 0;
+    }
+
+    std::string getChildPath(const std::string& parentPath, std::size_t index){
+        if(parentPath.empty()) return std::to_string(index);
+        return parentPath + "/" + std::to_string(index);
+    }
+
+    // Marks the longest increasing subsequence of _values
+    std::vector<bool> getIncreasingSubsequence(const std::vector<std::size_t>& _values){
+        std::vector<std::size_t> tails; // index in _values of the smallest tail of each length
+        std::vector<std::size_t> previous(_values.size());
+        for(std::size_t i = 0; i < _values.size(); ++i){
+            auto position = std::lower_bound(tails.begin(), tails.end(), _values[i], [&_values](std::size_t index, std::size_t value){
+                return _values[index] < value;
+            });
+            previous[i] = (position == tails.begin()) ? SIZE_MAX : *(position - 1);
+            if(position == tails.end()) tails.push_back(i);
+            else *position = i;
+        }
+        std::vector<bool> ret(_values.size(), false);
+        for(std::size_t i = tails.empty() ? SIZE_MAX : tails.back(); i != SIZE_MAX; i = previous[i]) ret[i] = true;
+        return ret;
+    }
+
+    // Counts of occupied positions (1 based), with prefix sums in O(log n)
+    struct PositionCounts {
+        std::vector<std::size_t> tree;
+        explicit PositionCounts(std::size_t _size) : tree(_size + 1, 0) {}
+        void add(std::size_t _position, bool _occupied){
+            for(; _position < tree.size(); _position += _position & (~_position + 1)){
+                if(_occupied) tree[_position]++;
+                else tree[_position]--;
+            }
+        }
+        // Occupied positions before _position
+        std::size_t countBefore(std::size_t _position) const {
+            std::size_t count = 0;
+            for(--_position; _position > 0; _position -= _position & (~_position + 1)) count += tree[_position];
+            return count;
+        }
+    };
+
+    struct DiffContext {
+        HashCache fromHashes;
+        HashCache toHashes;
+        pugi::xml_node patch;
+        DiffStats stats;
+
+        pugi::xml_node addOperation(const char* _type, const std::string& _path){
+            pugi::xml_node operation = patch.append_child(_type);
+            operation.append_attribute("path") = _path.c_str();
+            stats.numOperations++;
+            return operation;
+        }
+    };
+
+    void diffNodes(DiffContext& _context, const pugi::xml_node& a, const pugi::xml_node& b, const std::string& _path){
+        _context.stats.numNodesCompared++;
+
+        if(hashText(a.value()) != hashText(b.value())){
+            _context.addOperation("value", _path).append_attribute("value") = b.value();
+        }
+        for(pugi::xml_attribute attr = b.first_attribute(); attr; attr = attr.next_attribute()){
+            pugi::xml_attribute previous = a.attribute(attr.name());
+            if(!previous || std::strcmp(previous.value(), attr.value()) != 0){
+                pugi::xml_node operation = _context.addOperation("attribute", _path);
+                operation.append_attribute("name") = attr.name();
+                operation.append_attribute("value") = attr.value();
+            }
+        }
+        for(pugi::xml_attribute attr = a.first_attribute(); attr; attr = attr.next_attribute()){
+            if(!b.attribute(attr.name())){
+                _context.addOperation("removeAttribute", _path).append_attribute("name") = attr.name();
+            }
+        }
+
+        std::vector<pugi::xml_node> fromChildren, toChildren;
+        for(pugi::xml_node child = a.first_child(); child; child = child.next_sibling()) fromChildren.push_back(child);
+        for(pugi::xml_node child = b.first_child(); child; child = child.next_sibling()) toChildren.push_back(child);
+        if(fromChildren.empty() && toChildren.empty()) return;
+
+        // Match children : identical subtrees first, then same name and type, in order
+        const std::size_t noMatch = SIZE_MAX;
+        std::vector<std::size_t> matches(toChildren.size(), noMatch);
+        std::vector<bool> isMatched(fromChildren.size(), false);
+        {
+            std::unordered_map<std::uint64_t, std::vector<std::size_t> > byHash;
+            for(std::size_t j = fromChildren.size(); j-- > 0;){
+                byHash[_context.fromHashes.getHash(fromChildren[j])].push_back(j);
+            }
+            for(std::size_t i = 0; i < toChildren.size(); ++i){
+                auto found = byHash.find(_context.toHashes.getHash(toChildren[i]));
+                if(found == byHash.end() || found->second.empty()) continue;
+                matches[i] = found->second.back();
+                isMatched[matches[i]] = true;
+                found->second.pop_back();
+            }
+        }
+        {
+            std::unordered_map<std::string, std::vector<std::size_t> > byKind;
+            for(std::size_t j = fromChildren.size(); j-- > 0;){
+                if(isMatched[j]) continue;
+                byKind[char('0' + fromChildren[j].type()) + std::string(fromChildren[j].name())].push_back(j);
+            }
+            for(std::size_t i = 0; i < toChildren.size() && !byKind.empty(); ++i){
+                if(matches[i] != noMatch) continue;
+                auto found = byKind.find(char('0' + toChildren[i].type()) + std::string(toChildren[i].name()));
+                if(found == byKind.end() || found->second.empty()) continue;
+                matches[i] = found->second.back();
+                isMatched[matches[i]] = true;
+                found->second.pop_back();
+            }
+        }
+
+        // Removals, last first so indexes stay valid
+        for(std::size_t j = fromChildren.size(); j-- > 0;){
+            if(!isMatched[j]) _context.addOperation("remove", getChildPath(_path, j));
+        }
+
+        // Matched children forming the longest run in the same order stay in place,
+        // the others (and insertions) go right after their predecessor in the new order.
+        std::vector<std::size_t> order;
+        std::vector<std::size_t> orderToChild;
+        for(std::size_t i = 0; i < toChildren.size(); ++i){
+            if(matches[i] == noMatch) continue;
+            order.push_back(matches[i]);
+            orderToChild.push_back(i);
+        }
+        const std::vector<bool> inSequence = getIncreasingSubsequence(order);
+        std::vector<bool> staysInPlace(toChildren.size(), false);
+        for(std::size_t k = 0; k < order.size(); ++k) staysInPlace[orderToChild[k]] = inSequence[k];
+
+        // Moved and inserted children go right after their predecessor, which is at its final place : their slots can
+        // be linked in a list up front (the from slots of moved children stay, unused). Ranked in list order, a child's
+        // position while emitting operations is the number of occupied slots before its own.
+        // Ids : from index, or from count + to index when inserted. Slot 0 is the list head.
+        std::vector<std::size_t> nextSlot(1, noMatch);
+        std::vector<std::size_t> fromSlots(fromChildren.size(), noMatch);
+        std::vector<std::size_t> slotOf(fromChildren.size() + toChildren.size(), noMatch);
+        for(std::size_t j = 0; j < fromChildren.size(); ++j){
+            if(!isMatched[j]) continue;
+            fromSlots[j] = slotOf[j] = nextSlot.size();
+            nextSlot.back() = nextSlot.size();
+            nextSlot.push_back(noMatch);
+        }
+        std::vector<std::size_t> toSlots(toChildren.size(), noMatch);
+        std::size_t previousId = noMatch;
+        for(std::size_t i = 0; i < toChildren.size(); ++i){
+            const std::size_t id = (matches[i] != noMatch) ? matches[i] : fromChildren.size() + i;
+            if(!staysInPlace[i]){
+                const std::size_t after = (previousId == noMatch) ? 0 : slotOf[previousId];
+                toSlots[i] = slotOf[id] = nextSlot.size();
+                nextSlot.push_back(nextSlot[after]);
+                nextSlot[after] = toSlots[i];
+            }
+            previousId = id;
+        }
+        std::vector<std::size_t> ranks(nextSlot.size(), 0);
+        std::size_t rank = 0;
+        for(std::size_t slot = nextSlot[0]; slot != noMatch; slot = nextSlot[slot]) ranks[slot] = ++rank;
+
+        PositionCounts occupied(rank);
+        for(std::size_t j = 0; j < fromChildren.size(); ++j){
+            if(isMatched[j]) occupied.add(ranks[fromSlots[j]], true);
+        }
+        for(std::size_t i = 0; i < toChildren.size(); ++i){
+            if(staysInPlace[i]) continue;
+            if(matches[i] != noMatch){
+                const std::size_t from = occupied.countBefore(ranks[fromSlots[matches[i]]]);
+                occupied.add(ranks[fromSlots[matches[i]]], false);
+                const std::size_t to = occupied.countBefore(ranks[toSlots[i]]);
+                if(from != to){
+                    pugi::xml_node operation = _context.addOperation("move", getChildPath(_path, from));
+                    operation.append_attribute("to") = static_cast<unsigned int>(to);
+                }
+            }
+            else {
+                const std::size_t to = occupied.countBefore(ranks[toSlots[i]]);
+                _context.addOperation("insert", getChildPath(_path, to)).append_copy(toChildren[i]);
+            }
+            occupied.add(ranks[toSlots[i]], true);
+        }
+
+        // Now ordered like toChildren, compare the matched children that differ
+        for(std::size_t i = 0; i < toChildren.size(); ++i){
+            if(matches[i] == noMatch) continue;
+            const pugi::xml_node& fromChild = fromChildren[matches[i]];
+            if(_context.fromHashes.getHash(fromChild) == _context.toHashes.getHash(toChildren[i])) continue;
+            diffNodes(_context, fromChild, toChildren[i], getChildPath(_path, i));
+        }
+    }
+
+    double elapsedMs(const std::chrono::steady_clock::time_point& _start){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+}
+
+std::string getNodePath(const pugi::xml_node& _node, const pugi::xml_node& _root){
+    std::vector<std::size_t> indexes;
+    for(pugi::xml_node current = _node; current != _root && current.parent(); current = current.parent()){
+        std::size_t index = 0;
+        for(pugi::xml_node sibling = current.previous_sibling(); sibling; sibling = sibling.previous_sibling()) ++index;
+        indexes.push_back(index);
+    }
+    std::string path;
+    for(auto index = indexes.rbegin(); index != indexes.rend(); ++index){
+        if(!path.empty()) path.push_back('/');
+        path.append(std::to_string(*index));
+    }
+    return path;
+}
+
+pugi::xml_node findNodePath(const pugi::xml_node& _root, const char* _path){
+    pugi::xml_node node = _root;
+    while(node && _path != nullptr && *_path != 0){
+        char* end = nullptr;
+        unsigned long index = std::strtoul(_path, &end, 10);
+        if(end == _path) return pugi::xml_node();
+        node = node.first_child();
+        while(node && index-- > 0) node = node.next_sibling();
+        _path = (*end == '/') ? end + 1 : end;
+    }
+    return node;
+}
+
+std::size_t diff(const pugi::xml_node& _from, const pugi::xml_node& _to, pugi::xml_node _patch, DiffStats* _stats){
+    DiffContext context;
+    context.patch = _patch;
+
+    auto start = std::chrono::steady_clock::now();
+    const std::uint64_t fromHash = context.fromHashes.getHash(_from);
+    const std::uint64_t toHash = context.toHashes.getHash(_to);
+    context.stats.hashMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    if(fromHash != toHash){
+        if(isSameKind(_from, _to)) diffNodes(context, _from, _to, "");
+        else context.addOperation("replace", "").append_copy(_to);
+    }
+    context.stats.diffMs = elapsedMs(start);
+
+    if(_stats != nullptr) *_stats = context.stats;
+    return context.stats.numOperations;
+}
+
+bool patch(pugi::xml_node _target, const pugi::xml_node& _patch){
+    bool ret = true;
+    for(pugi::xml_node operation = _patch.first_child(); operation; operation = operation.next_sibling()){
+        if(operation.type() != pugi::node_element) continue;
+        const char* type = operation.name();
+        const char* path = operation.attribute("path").value();
+
+        if(std::strcmp(type, "insert") == 0){
+            // Path of the inserted node : parent path + index
+            const char* separator = std::strrchr(path, '/');
+            const std::string parentPath = (separator != nullptr) ? std::string(path, separator) : std::string();
+            const unsigned long index = std::strtoul(separator != nullptr ? separator + 1 : path, nullptr, 10);
+            pugi::xml_node parent = findNodePath(_target, parentPath.c_str());
+            pugi::xml_node content = operation.first_child();
+            pugi::xml_node before = parent.first_child();
+            for(unsigned long i = 0; before && i < index; ++i) before = before.next_sibling();
+            if(!parent || !content) ret = false;
+            else if(before) ret &= (bool)parent.insert_copy_before(content, before);
+            else ret &= (bool)parent.append_copy(content);
+            continue;
+        }
+
+        pugi::xml_node node = findNodePath(_target, path);
+        if(!node){
+            ret = false;
+            continue;
+        }
+        if(std::strcmp(type, "remove") == 0){
+            ret &= node.parent().remove_child(node);
+        }
+        else if(std::strcmp(type, "move") == 0){
+            pugi::xml_node parent = node.parent();
+            const unsigned int to = operation.attribute("to").as_uint();
+            if(to == 0){
+                ret &= (bool)parent.prepend_move(node);
+            }
+            else {
+                // Index `to` once node is out of the list
+                pugi::xml_node after = parent.first_child();
+                for(unsigned int i = 0; after; after = after.next_sibling()){
+                    if(after == node) continue;
+                    if(++i == to) break;
+                }
+                ret &= after && parent.insert_move_after(node, after);
+            }
+        }
+        else if(std::strcmp(type, "replace") == 0){
+            if(node.type() == pugi::node_document || !node.parent()){
+                while(node.first_child()) node.remove_child(node.first_child());
+                for(pugi::xml_node content = operation.first_child(); content; content = content.next_sibling()) node.append_copy(content);
+            }
+            else if(pugi::xml_node content = operation.first_child()){
+                node.parent().insert_copy_after(content, node);
+                node.parent().remove_child(node);
+            }
+            else ret = false;
+        }
+        else if(std::strcmp(type, "attribute") == 0){
+            const char* name = operation.attribute("name").value();
+            pugi::xml_attribute attr = node.attribute(name);
+            if(!attr) attr = node.append_attribute(name);
+            ret &= attr.set_value(operation.attribute("value").value());
+        }
+        else if(std::strcmp(type, "removeAttribute") == 0){
+            ret &= node.remove_attribute(operation.attribute("name").value());
+        }
+        else if(std::strcmp(type, "value") == 0){
+            ret &= node.set_value(operation.attribute("value").value());
+        }
+        else ret = false;
+    }
+    return ret;
+}
+
+}
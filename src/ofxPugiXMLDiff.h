@@ -0,0 +1,69 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <cstddef>
+#include <string>
+
+namespace ofxPugiXml {
+
+    struct DiffStats {
+        std::size_t numOperations = 0;
+        std::size_t numNodesCompared = 0; // pairs of nodes whose subtree hashes differed
+        double hashMs = 0;
+        double diffMs = 0;
+    };
+
+    // Structural diff
+    // Appends to _patch the operations turning _from into _to and returns their count (0 when equal).
+    // Subtrees are compared by hash first, so unchanged parts of big documents cost a single comparison.
+    // Children are matched by content, then by name : moved, inserted and removed nodes, changed attributes and
+    // values become individual operations, the patch size is proportional to the change.
+    // Comparisons ignore attribute order and whitespace differences in text (see ofxPugiXml::hashNode()).
+    // Patch format (paths are child indexes from the diffed node, `/` separated, applied in order) :
+    //     <remove path="0/4"/>
+    //     <insert path="0/2"><newNode .../></insert>
+    //     <move path="0/3" to="0"/>
+    //     <replace path="0/1"><node .../></replace>
+    //     <attribute path="0/1" name="x" value="12"/>
+    //     <removeAttribute path="0/1" name="y"/>
+    //     <value path="0/1/0" value="text"/>
+    // Usage :
+    //     pugi::xml_document patch;
+    //     if(ofxPugiXml::diff(previous, current, patch)) send(patch);
+    //     // receiver :
+    //     ofxPugiXml::patch(doc, patch);
+    std::size_t diff(const pugi::xml_node& _from, const pugi::xml_node& _to, pugi::xml_node _patch, DiffStats* _stats = nullptr);
+
+    // Node paths : child indexes (counting all node types) from _root, or from the document, `/` separated.
+    std::string getNodePath(const pugi::xml_node& _node, const pugi::xml_node& _root = pugi::xml_node());
+    pugi::xml_node findNodePath(const pugi::xml_node& _root, const char* _path);
+
+    // Applies the operations (children of _patch) to _target, which has to equal the diff's _from.
+    // Returns false if an operation doesn't apply (the following ones are still applied).
+    bool patch(pugi::xml_node _target, const pugi::xml_node& _patch);
+}
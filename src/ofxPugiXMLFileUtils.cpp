@@ -0,0 +1,289 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#include "ofxPugiXMLFileUtils.h"
+#include "ofFileUtils.h" // ofToDataPath
+#include <cstdio>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h> // _get_osfhandle
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ofxPugiXml {
+
+// Returns the size of an open file, or -1 on failure. (64 bit safe on all platforms)
+static std::int64_t getFileSize(std::FILE* _file){
+#ifdef _WIN32
+    if(_fseeki64(_file, 0, SEEK_END) != 0) return -1;
+    const std::int64_t size = _ftelli64(_file);
+    if(_fseeki64(_file, 0, SEEK_SET) != 0) return -1;
+#else
+    if(fseeko(_file, 0, SEEK_END) != 0) return -1;
+    const std::int64_t size = ftello(_file);
+    if(fseeko(_file, 0, SEEK_SET) != 0) return -1;
+#endif
+    return size;
+}
+
+pugi::xml_parse_result loadFileInPlace(pugi::xml_document& _doc, const std::string& _path, unsigned int _parseOptions, pugi::xml_encoding _encoding){
+    const std::string fullPath = ofToDataPath(_path);
+
+    // Like pugi's load_file(), a failed load leaves an empty document
+    std::FILE* file = std::fopen(fullPath.c_str(), "rb");
+    if(file == nullptr){
+        _doc.reset();
+        return makeParseResult(pugi::status_file_not_found);
+    }
+
+    const std::int64_t fileSize = getFileSize(file);
+    if(fileSize < 0 || static_cast<std::uint64_t>(fileSize) > SIZE_MAX){
+        std::fclose(file);
+        _doc.reset();
+        return makeParseResult(pugi::status_io_error);
+    }
+
+    // Allocate with pugi's allocator so the document can free it once it's done.
+    // Note: pugi needs a non-zero size, an empty file gives a 1 byte buffer which won't be parsed.
+    const size_t bufferSize = static_cast<size_t>(fileSize);
+    void* buffer = pugi::get_memory_allocation_function()(bufferSize > 0 ? bufferSize : 1);
+    if(buffer == nullptr){
+        std::fclose(file);
+        _doc.reset();
+        return makeParseResult(pugi::status_out_of_memory);
+    }
+
+    const size_t readSize = std::fread(buffer, 1, bufferSize, file);
+    std::fclose(file);
+    if(readSize != bufferSize){
+        pugi::get_memory_deallocation_function()(buffer);
+        _doc.reset();
+        return makeParseResult(pugi::status_io_error);
+    }
+
+    // Takes ownership of the buffer, even on failure.
+    return _doc.load_buffer_inplace_own(buffer, bufferSize, _parseOptions, _encoding);
+}
+
+//--------------------------------------------------------------
+MappedFile::MappedFile(){
+
+}
+
+MappedFile::~MappedFile(){
+    close();
+}
+
+bool MappedFile::open(const std::string& _path){
+    close();
+    const std::string fullPath = ofToDataPath(_path);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if(mapping == nullptr){
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if(view == nullptr){
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = view;
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(fullPath.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat fileStat;
+    if(::fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0){
+        ::close(fd);
+        return false;
+    }
+
+    // Private + writable : pugi's in-place parser may write to it, the file itself is never modified.
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if(view == MAP_FAILED) return false;
+
+    data = view;
+    size = static_cast<std::size_t>(fileStat.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close(){
+    if(data == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    ::munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool MappedFile::advise(MappedFileAccess _access){
+    if(data == nullptr) return false;
+#ifdef _WIN32
+    // Windows only knows about prefetching (Windows 8+)
+#if _WIN32_WINNT >= 0x0602
+    if(_access == MappedFileAccess::WillNeed){
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = data;
+        range.NumberOfBytes = size;
+        return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+    return true;
+#else
+    int advice = MADV_NORMAL;
+    switch(_access){
+        case MappedFileAccess::Normal:     advice = MADV_NORMAL; break;
+        case MappedFileAccess::Sequential: advice = MADV_SEQUENTIAL; break;
+        case MappedFileAccess::Random:     advice = MADV_RANDOM; break;
+        case MappedFileAccess::WillNeed:   advice = MADV_WILLNEED; break;
+    }
+    return ::madvise(data, size, advice) == 0;
+#endif
+}
+
+//--------------------------------------------------------------
+pugi::xml_parse_result loadFileMapped(pugi::xml_document& _doc, std::shared_ptr<MappedFile>& _mapping, const std::string& _path, MappedFileAccess _access, unsigned int _parseOptions, pugi::xml_encoding _encoding){
+    std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+    if(!mapping->open(_path)){
+        // Release the document first, it might point into the previous mapping
+        _doc.reset();
+        _mapping.reset();
+        return makeParseResult(pugi::status_file_not_found);
+    }
+
+    // The parser walks the whole buffer once
+    mapping->advise(MappedFileAccess::Sequential);
+
+    // Not owned : the buffer stays valid as long as the mapping lives
+    pugi::xml_parse_result result = _doc.load_buffer_inplace(mapping->getData(), mapping->getSize(), _parseOptions, _encoding);
+
+    if(_access != MappedFileAccess::Sequential) mapping->advise(_access);
+
+    // The document now references the new mapping, the old one can be released.
+    _mapping = mapping;
+    return result;
+}
+
+//--------------------------------------------------------------
+void FileWriter::write(const void* _data, size_t _size){
+    if(std::fwrite(_data, 1, _size, file) != _size) failed = true;
+}
+
+bool syncFile(std::FILE* _file){
+    if(std::fflush(_file) != 0) return false;
+#ifdef _WIN32
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(_file)))) != 0;
+#else
+    return fsync(fileno(_file)) == 0;
+#endif
+}
+
+bool saveFileAtomic(const pugi::xml_document& _doc, const std::string& _path, const char* _indent, unsigned int _flags, pugi::xml_encoding _encoding){
+    return saveFileAtomic(_path, [&](std::FILE* _file){
+        FileWriter writer;
+        writer.file = _file;
+        _doc.save(writer, _indent, _flags, _encoding);
+        return !writer.failed;
+    });
+}
+
+bool saveFileAtomic(const std::string& _path, const std::function<bool(std::FILE*)>& _write){
+    const std::string fullPath = ofToDataPath(_path);
+    const std::string tempPath = fullPath + ".tmp";
+
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if(file == nullptr) return false;
+    const bool synced = _write(file) && syncFile(file);
+    const bool closed = (std::fclose(file) == 0);
+    if(!synced || !closed){
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    const bool replaced = MoveFileExA(tempPath.c_str(), fullPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    const bool replaced = std::rename(tempPath.c_str(), fullPath.c_str()) == 0;
+#endif
+    if(!replaced) std::remove(tempPath.c_str());
+    return replaced;
+}
+
+bool getFileInfo(const std::string& _path, std::uint64_t& _size, std::int64_t& _modificationTime){
+    const std::string fullPath = ofToDataPath(_path);
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if(!GetFileAttributesExA(fullPath.c_str(), GetFileExInfoStandard, &info)) return false;
+    _size = (std::uint64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    // 100ns intervals
+    _modificationTime = ((std::int64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime) * 100;
+#else
+    struct stat info;
+    if(stat(fullPath.c_str(), &info) != 0) return false;
+    _size = static_cast<std::uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    _modificationTime = std::int64_t(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    _modificationTime = std::int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
+} // namespace ofxPugiXml
@@ -0,0 +1,119 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+// File loading utilities
+// Avoids the ofBuffer -> std::string -> pugi copies when loading large documents.
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+namespace ofxPugiXml {
+    // Reads a whole file into a single buffer allocated with pugixml's allocator, then parses it in-place.
+    // The document takes ownership of the buffer, so the file is held in memory only once.
+    // On failure the document is reset, like pugi::xml_document::load_file().
+    // Paths are relative to the data folder, like ofBufferFromFile().
+    pugi::xml_parse_result loadFileInPlace(pugi::xml_document& _doc, const std::string& _path, unsigned int _parseOptions=pugi::parse_default, pugi::xml_encoding _encoding=pugi::encoding_auto);
+
+    // Access pattern hints for memory-mapped files (maps to madvise, partially supported on Windows)
+    enum class MappedFileAccess {
+        Normal,     // No particular hint, let the OS decide
+        Sequential, // Pages are read in order (parsing, full traversals) : aggressive read-ahead
+        Random,     // Sparse lookups : no read-ahead
+        WillNeed,   // Start paging in the whole file now
+    };
+
+    // A private (copy-on-write) memory mapping of a file.
+    // Pages are faulted in lazily and shared with other processes mapping the same file, until they're written to :
+    // written pages become private copies, owned by this process only.
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Path is relative to the data folder.
+        bool open(const std::string& _path);
+        void close();
+        bool isOpen() const { return data != nullptr; }
+
+        bool advise(MappedFileAccess _access);
+
+        void* getData() { return data; }
+        const void* getData() const { return data; }
+        std::size_t getSize() const { return size; }
+
+    private:
+        void* data = nullptr;
+        std::size_t size = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+
+    // Maps a file and parses it in-place from the mapping, without any heap copy of the file.
+    // The mapping is referenced by the document nodes : keep _mapping alive as long as _doc isn't reset or reloaded.
+    // The mapping is advised as sequential while parsing, then _access is applied.
+    // Notes :
+    //     The parser writes string terminators all over the buffer, so nearly every page of the mapping becomes private :
+    //     the loaded document is not shared with other processes loading the same file, each one holds its own copy.
+    //     What the mapping saves is the read() into a heap buffer : pages are faulted in as the parser reaches them.
+    pugi::xml_parse_result loadFileMapped(pugi::xml_document& _doc, std::shared_ptr<MappedFile>& _mapping, const std::string& _path, MappedFileAccess _access=MappedFileAccess::Normal, unsigned int _parseOptions=pugi::parse_default, pugi::xml_encoding _encoding=pugi::encoding_auto);
+
+    // Saves a document atomically : it's written and synced to `<path>.tmp`, which then replaces the file.
+    // A crash or failure leaves either the previous or the new file, never a truncated one.
+    bool saveFileAtomic(const pugi::xml_document& _doc, const std::string& _path, const char* _indent="\t", unsigned int _flags=pugi::format_default, pugi::xml_encoding _encoding=pugi::encoding_auto);
+    // Same, for any content : _write fills the file and returns false on failure.
+    bool saveFileAtomic(const std::string& _path, const std::function<bool(std::FILE*)>& _write);
+
+    // Size and modification time (in nanoseconds, as precise as the file system) of a file. False if it doesn't exist.
+    bool getFileInfo(const std::string& _path, std::uint64_t& _size, std::int64_t& _modificationTime);
+
+    // Flushes and syncs an open file to disk
+    bool syncFile(std::FILE* _file);
+
+    // Writes to an open FILE*, remembering failures
+    struct FileWriter : public pugi::xml_writer {
+        std::FILE* file = nullptr;
+        bool failed = false;
+        void write(const void* _data, size_t _size) override;
+    };
+
+    // Returns a parse result with the given status, used to report I/O errors like pugixml does.
+    inline pugi::xml_parse_result makeParseResult(pugi::xml_parse_status _status){
+        pugi::xml_parse_result result;
+        result.status = _status;
+        result.offset = 0;
+        result.encoding = pugi::encoding_auto;
+        return result;
+    }
+} // namespace ofxPugiXml
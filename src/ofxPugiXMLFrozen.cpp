@@ -0,0 +1,284 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofxPugiXMLFrozen.h"
+#include <cstring>
+
+namespace ofxPugiXml {
+
+//--------------------------------------------------------------
+bool FrozenDocument::freeze(const pugi::xml_node& _root){
+    clear();
+    if(!_root) return false;
+    valueStrings.push_back('\0');
+
+    // Iterative pre-order walk, documents can be deeper than the stack
+    std::vector<std::uint32_t> parentStack;
+    std::vector<std::uint32_t> lastChildren;
+    auto addNode = [this](const pugi::xml_node& node, std::uint32_t parent) -> bool {
+        if(types.size() >= noIndex - 1) return false;
+        std::uint32_t value = 0;
+        if(!addValue(node.value(), value)) return false;
+        types.push_back(static_cast<std::uint8_t>(node.type()));
+        nameIds.push_back(intern(node.name()));
+        values.push_back(value);
+        parents.push_back(parent);
+        firstChildren.push_back(noIndex);
+        nextSiblings.push_back(noIndex);
+        firstAttributes.push_back(static_cast<std::uint32_t>(attributeNameIds.size()));
+        for(pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute()){
+            if(attributeNameIds.size() >= noIndex - 1 || !addValue(attr.value(), value)) return false;
+            attributeNameIds.push_back(intern(attr.name()));
+            attributeValues.push_back(value);
+        }
+        return true;
+    };
+
+    bool success = addNode(_root, noIndex);
+    parentStack.push_back(0);
+    lastChildren.push_back(noIndex);
+    pugi::xml_node node = _root.first_child();
+    while(success && node){
+        const std::uint32_t index = static_cast<std::uint32_t>(types.size());
+        if(!(success = addNode(node, parentStack.back()))) break;
+        if(lastChildren.back() == noIndex) firstChildren[parentStack.back()] = index;
+        else nextSiblings[lastChildren.back()] = index;
+        lastChildren.back() = index;
+
+        if(node.first_child()){
+            parentStack.push_back(index);
+            lastChildren.push_back(noIndex);
+            node = node.first_child();
+            continue;
+        }
+        // Climb up to the next node in document order
+        while(node != _root && !node.next_sibling()){
+            node = node.parent();
+            parentStack.pop_back();
+            lastChildren.pop_back();
+        }
+        if(node == _root) break;
+        node = node.next_sibling();
+    }
+    if(!success){
+        clear();
+        return false;
+    }
+    firstAttributes.push_back(static_cast<std::uint32_t>(attributeNameIds.size()));
+
+    // Children come after their parent : accumulate sizes backwards
+    subtreeSizes.assign(types.size(), 1);
+    for(std::size_t i = types.size() - 1; i > 0; --i) subtreeSizes[parents[i]] += subtreeSizes[i];
+
+    // Construction is over, release the growth slack
+    for(std::vector<std::uint32_t>* array : { &nameIds, &values, &parents, &firstChildren, &nextSiblings, &firstAttributes, &attributeNameIds, &attributeValues }){
+        array->shrink_to_fit();
+    }
+    types.shrink_to_fit();
+    valueStrings.shrink_to_fit();
+    return true;
+}
+
+void FrozenDocument::clear(){
+    types.clear();
+    nameIds.clear();
+    values.clear();
+    parents.clear();
+    firstChildren.clear();
+    nextSiblings.clear();
+    subtreeSizes.clear();
+    firstAttributes.clear();
+    attributeNameIds.clear();
+    attributeValues.clear();
+    valueStrings.clear();
+    names.clear();
+    nameTable.clear();
+}
+
+std::uint32_t FrozenDocument::intern(const char* _name){
+    auto found = nameTable.find(_name);
+    if(found != nameTable.end()) return found->second;
+    const std::uint32_t id = static_cast<std::uint32_t>(names.size());
+    names.emplace_back(_name);
+    nameTable.emplace(names.back(), id);
+    return id;
+}
+
+bool FrozenDocument::addValue(const char* _value, std::uint32_t& _offset){
+    const std::size_t length = std::strlen(_value);
+    if(length == 0){
+        _offset = 0;
+        return true;
+    }
+    if(valueStrings.size() + length + 1 > noIndex) return false;
+    _offset = static_cast<std::uint32_t>(valueStrings.size());
+    valueStrings.insert(valueStrings.end(), _value, _value + length + 1);
+    return true;
+}
+
+FrozenNode FrozenDocument::getRoot() const{
+    return makeNode(empty() ? noIndex : 0);
+}
+
+std::uint32_t FrozenDocument::getNameId(const char* _name) const{
+    auto found = nameTable.find(_name);
+    return found != nameTable.end() ? found->second : noName;
+}
+
+const char* FrozenDocument::getName(std::uint32_t _nameId) const{
+    return _nameId < names.size() ? names[_nameId].c_str() : "";
+}
+
+void FrozenDocument::findAll(const FrozenNode& _node, std::uint32_t _nameId, std::vector<FrozenNode>& _results) const{
+    if(!_node || _node.document != this || _nameId == noName) return;
+    const std::uint32_t end = _node.index + subtreeSizes[_node.index];
+    for(std::uint32_t i = _node.index + 1; i < end; ++i){
+        if(nameIds[i] == _nameId) _results.push_back(FrozenNode(this, i));
+    }
+}
+
+std::size_t FrozenDocument::getMemoryUsage() const{
+    std::size_t size = types.capacity() + valueStrings.capacity();
+    for(const std::vector<std::uint32_t>* array : { &nameIds, &values, &parents, &firstChildren, &nextSiblings, &subtreeSizes, &firstAttributes, &attributeNameIds, &attributeValues }){
+        size += array->capacity() * sizeof(std::uint32_t);
+    }
+    for(const std::string& name : names) size += name.capacity() + sizeof(std::string);
+    return size;
+}
+
+// Frozen nodes
+pugi::xml_node_type FrozenNode::type() const{
+    if(!document) return pugi::node_null;
+    return static_cast<pugi::xml_node_type>(document->types[index]);
+}
+
+const char* FrozenNode::name() const{
+    if(!document) return "";
+    return document->names[document->nameIds[index]].c_str();
+}
+
+std::uint32_t FrozenNode::getNameId() const{
+    if(!document) return FrozenDocument::noName;
+    return document->nameIds[index];
+}
+
+const char* FrozenNode::value() const{
+    if(!document) return "";
+    return document->valueStrings.data() + document->values[index];
+}
+
+const char* FrozenNode::text(const char* _default) const{
+    for(FrozenNode child = firstChild(); child; child = child.nextSibling()){
+        if(child.type() == pugi::node_pcdata || child.type() == pugi::node_cdata) return child.value();
+    }
+    return _default;
+}
+
+FrozenNode FrozenNode::parent() const{
+    if(!document) return FrozenNode();
+    return document->makeNode(document->parents[index]);
+}
+
+FrozenNode FrozenNode::firstChild() const{
+    if(!document) return FrozenNode();
+    return document->makeNode(document->firstChildren[index]);
+}
+
+FrozenNode FrozenNode::nextSibling() const{
+    if(!document) return FrozenNode();
+    return document->makeNode(document->nextSiblings[index]);
+}
+
+FrozenNode FrozenNode::child(const char* _name) const{
+    if(!document) return FrozenNode();
+    const std::uint32_t nameId = document->getNameId(_name);
+    return (nameId == FrozenDocument::noName) ? FrozenNode() : child(nameId);
+}
+
+FrozenNode FrozenNode::child(std::uint32_t _nameId) const{
+    for(FrozenNode child = firstChild(); child; child = child.nextSibling()){
+        if(document->nameIds[child.index] == _nameId) return child;
+    }
+    return FrozenNode();
+}
+
+FrozenNode FrozenNode::nextSibling(std::uint32_t _nameId) const{
+    for(FrozenNode sibling = nextSibling(); sibling; sibling = sibling.nextSibling()){
+        if(document->nameIds[sibling.index] == _nameId) return sibling;
+    }
+    return FrozenNode();
+}
+
+std::size_t FrozenNode::getSubtreeSize() const{
+    if(!document) return 0;
+    return document->subtreeSizes[index];
+}
+
+std::size_t FrozenNode::getNumAttributes() const{
+    if(!document) return 0;
+    return document->firstAttributes[index + 1] - document->firstAttributes[index];
+}
+
+const char* FrozenNode::getAttributeName(std::size_t _attribute) const{
+    if(_attribute >= getNumAttributes()) return "";
+    return document->names[document->attributeNameIds[document->firstAttributes[index] + _attribute]].c_str();
+}
+
+std::uint32_t FrozenNode::getAttributeNameId(std::size_t _attribute) const{
+    if(_attribute >= getNumAttributes()) return FrozenDocument::noName;
+    return document->attributeNameIds[document->firstAttributes[index] + _attribute];
+}
+
+const char* FrozenNode::getAttributeValue(std::size_t _attribute) const{
+    if(_attribute >= getNumAttributes()) return "";
+    return document->valueStrings.data() + document->attributeValues[document->firstAttributes[index] + _attribute];
+}
+
+const char* FrozenNode::attribute(const char* _name) const{
+    if(!document) return nullptr;
+    const std::uint32_t nameId = document->getNameId(_name);
+    return (nameId == FrozenDocument::noName) ? nullptr : attribute(nameId);
+}
+
+const char* FrozenNode::attribute(std::uint32_t _nameId) const{
+    if(!document) return nullptr;
+    const std::uint32_t end = document->firstAttributes[index + 1];
+    for(std::uint32_t i = document->firstAttributes[index]; i < end; ++i){
+        if(document->attributeNameIds[i] == _nameId) return document->valueStrings.data() + document->attributeValues[i];
+    }
+    return nullptr;
+}
+
+FrozenRange<FrozenChildIterator> FrozenNode::children() const{
+    return { FrozenChildIterator(firstChild()), FrozenChildIterator(FrozenNode()) };
+}
+
+FrozenRange<FrozenDescendantIterator> FrozenNode::descendants() const{
+    if(!document) return { FrozenDescendantIterator(nullptr, 0), FrozenDescendantIterator(nullptr, 0) };
+    return { FrozenDescendantIterator(document, index + 1), FrozenDescendantIterator(document, index + static_cast<std::uint32_t>(getSubtreeSize())) };
+}
+
+}
@@ -0,0 +1,329 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLHelpers.h"
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ofxPugiXml {
+
+    class FrozenDocument;
+    class FrozenChildIterator;
+    class FrozenDescendantIterator;
+    template<typename ITERATOR> struct FrozenRange;
+
+    // Read-only view of a node of a FrozenDocument (a document and an index, cheap to copy)
+    class FrozenNode {
+    public:
+        FrozenNode(){}
+        explicit operator bool() const { return document != nullptr; }
+        bool operator==(const FrozenNode& _other) const { return document == _other.document && index == _other.index; }
+        bool operator!=(const FrozenNode& _other) const { return !(*this == _other); }
+
+        pugi::xml_node_type type() const;
+        const char* name() const;
+        std::uint32_t getNameId() const;
+        const char* value() const;
+        // Value of the first text (pcdata or cdata) child, or _default if there's none
+        const char* text(const char* _default = "") const;
+
+        FrozenNode parent() const;
+        FrozenNode firstChild() const;
+        FrozenNode nextSibling() const;
+        FrozenNode child(const char* _name) const;
+        FrozenNode child(std::uint32_t _nameId) const;
+        FrozenNode nextSibling(std::uint32_t _nameId) const;
+        // Number of nodes in the subtree, this one included
+        std::size_t getSubtreeSize() const;
+
+        std::size_t getNumAttributes() const;
+        const char* getAttributeName(std::size_t _attribute) const;
+        std::uint32_t getAttributeNameId(std::size_t _attribute) const;
+        const char* getAttributeValue(std::size_t _attribute) const;
+        // Value of the named attribute, nullptr if there's none
+        const char* attribute(const char* _name) const;
+        const char* attribute(std::uint32_t _nameId) const;
+
+        // Children, following the sibling links
+        FrozenRange<FrozenChildIterator> children() const;
+        // Descendants in document order : a contiguous range of indexes
+        FrozenRange<FrozenDescendantIterator> descendants() const;
+
+        std::uint32_t getIndex() const { return index; }
+
+    private:
+        friend class FrozenDocument;
+        friend class FrozenDescendantIterator;
+        FrozenNode(const FrozenDocument* _document, std::uint32_t _index) : document(_document), index(_index){}
+        const FrozenDocument* document = nullptr;
+        std::uint32_t index = 0;
+    };
+
+    // Iterators over frozen nodes
+    class FrozenChildIterator {
+    public:
+        explicit FrozenChildIterator(const FrozenNode& _node) : node(_node){}
+        const FrozenNode& operator*() const { return node; }
+        const FrozenNode* operator->() const { return &node; }
+        FrozenChildIterator& operator++(){ node = node.nextSibling(); return *this; }
+        bool operator!=(const FrozenChildIterator& _other) const { return node != _other.node; }
+        bool operator==(const FrozenChildIterator& _other) const { return node == _other.node; }
+    private:
+        FrozenNode node;
+    };
+    class FrozenDescendantIterator {
+    public:
+        FrozenDescendantIterator(const FrozenDocument* _document, std::uint32_t _index) : document(_document), index(_index){}
+        FrozenNode operator*() const { return FrozenNode(document, index); }
+        FrozenDescendantIterator& operator++(){ ++index; return *this; }
+        bool operator!=(const FrozenDescendantIterator& _other) const { return index != _other.index; }
+        bool operator==(const FrozenDescendantIterator& _other) const { return index == _other.index; }
+    private:
+        const FrozenDocument* document;
+        std::uint32_t index;
+    };
+    template<typename ITERATOR>
+    struct FrozenRange {
+        ITERATOR first, last;
+        ITERATOR begin() const { return first; }
+        ITERATOR end() const { return last; }
+    };
+
+    // Frozen documents
+    // An immutable copy of a document, flattened into contiguous arrays (structure of arrays) in document order :
+    // each node is an index, its type, interned name, value, parent, first child, next sibling and subtree size
+    // are entries of separate arrays. Traversals read memory linearly instead of chasing pointers across pages,
+    // a subtree is a range of indexes, and searching for a name compares integers.
+    // Usage :
+    //     ofxPugiXml::FrozenDocument frozen;
+    //     frozen.freeze(doc);
+    //     const std::uint32_t meshId = frozen.getNameId("mesh");
+    //     for(ofxPugiXml::FrozenNode node : frozen.getRoot().descendants()){
+    //         if(node.getNameId() == meshId) ofxPugiXml::getNodeAttributeValue(node, "position", position);
+    //     }
+    // Notes :
+    // - The frozen copy doesn't reference the document, which can be modified or destroyed afterwards.
+    // - Nodes are only valid as long as their FrozenDocument isn't refrozen, cleared or destroyed.
+    class FrozenDocument {
+    public:
+        static constexpr std::uint32_t noName = 0xffffffff;
+
+        // Copies _root and its subtree. Returns false (and stays empty) past 4G nodes, attributes or bytes of values.
+        bool freeze(const pugi::xml_node& _root);
+        void clear();
+        bool empty() const { return types.empty(); }
+
+        FrozenNode getRoot() const;
+
+        // Interned names : noName if no node or attribute has that name
+        std::uint32_t getNameId(const char* _name) const;
+        const char* getName(std::uint32_t _nameId) const;
+        std::size_t getNumNames() const { return names.size(); }
+
+        // Appends the descendants of _node named _nameId, in document order. Scans the contiguous name array.
+        void findAll(const FrozenNode& _node, std::uint32_t _nameId, std::vector<FrozenNode>& _results) const;
+
+        std::size_t getNumNodes() const { return types.size(); }
+        std::size_t getNumAttributes() const { return attributeNameIds.size(); }
+        // Heap memory used by the arrays
+        std::size_t getMemoryUsage() const;
+
+    protected:
+        friend class FrozenNode;
+        static constexpr std::uint32_t noIndex = 0xffffffff;
+
+        std::uint32_t intern(const char* _name);
+        bool addValue(const char* _value, std::uint32_t& _offset);
+        FrozenNode makeNode(std::uint32_t _index) const { return _index == noIndex ? FrozenNode() : FrozenNode(this, _index); }
+
+        // Nodes
+        std::vector<std::uint8_t> types;
+        std::vector<std::uint32_t> nameIds;
+        std::vector<std::uint32_t> values; // offsets in valueStrings
+        std::vector<std::uint32_t> parents;
+        std::vector<std::uint32_t> firstChildren;
+        std::vector<std::uint32_t> nextSiblings;
+        std::vector<std::uint32_t> subtreeSizes;
+        std::vector<std::uint32_t> firstAttributes; // numNodes + 1 entries, attributes of node i are [first[i], first[i+1])
+        // Attributes
+        std::vector<std::uint32_t> attributeNameIds;
+        std::vector<std::uint32_t> attributeValues;
+        // Strings
+        std::vector<char> valueStrings; // 0 is the empty string
+        std::vector<std::string> names;
+        std::unordered_map<std::string, std::uint32_t> nameTable;
+    };
+
+    // Helpers on frozen nodes
+    // Same behaviour as their pugi::xml_node counterparts, text is converted like pugi's as_*() conversions do.
+    namespace frozen {
+        // Port of pugi's string_to_integer() : decimal, or hexadecimal with a 0x prefix (leading zeros don't mean octal),
+        // out of range values saturate to _min / _max, an empty or invalid text gives 0.
+        template<typename UNSIGNED>
+        inline UNSIGNED parseInteger(const char* _text, UNSIGNED _min, UNSIGNED _max){
+            UNSIGNED result = 0;
+            const char* s = _text;
+            while(*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') ++s;
+            const bool negative = (*s == '-');
+            s += (*s == '+' || *s == '-');
+            bool overflow = false;
+            if(s[0] == '0' && (s[1] | ' ') == 'x'){
+                s += 2;
+                while(*s == '0') ++s; // leading zeros don't count against the digit limit
+                const char* start = s;
+                for(;;){
+                    if(static_cast<unsigned>(*s - '0') < 10) result = result * 16 + (*s - '0');
+                    else if(static_cast<unsigned>((*s | ' ') - 'a') < 6) result = result * 16 + ((*s | ' ') - 'a' + 10);
+                    else break;
+                    ++s;
+                }
+                overflow = std::size_t(s - start) > sizeof(UNSIGNED) * 2;
+            }
+            else{
+                while(*s == '0') ++s;
+                const char* start = s;
+                while(static_cast<unsigned>(*s - '0') < 10){
+                    result = result * 10 + (*s - '0');
+                    ++s;
+                }
+                const std::size_t numDigits = static_cast<std::size_t>(s - start);
+                const std::size_t maxDigits = sizeof(UNSIGNED) == 8 ? 20 : 10;
+                const char maxLead = sizeof(UNSIGNED) == 8 ? '1' : '4';
+                const std::size_t highBit = sizeof(UNSIGNED) * 8 - 1;
+                overflow = numDigits >= maxDigits && !(numDigits == maxDigits && (*start < maxLead || (*start == maxLead && (result >> highBit))));
+            }
+            if(negative) return (overflow || result > 0 - _min) ? _min : 0 - result;
+            return (overflow || result > _max) ? _max : result;
+        }
+        inline void parseValue(const char* _text, float& _value){ _value = static_cast<float>(std::strtod(_text, nullptr)); }
+        inline void parseValue(const char* _text, double& _value){ _value = std::strtod(_text, nullptr); }
+        inline void parseValue(const char* _text, int& _value){ _value = static_cast<int>(parseInteger<unsigned int>(_text, static_cast<unsigned int>(INT_MIN), INT_MAX)); }
+        inline void parseValue(const char* _text, unsigned int& _value){ _value = parseInteger<unsigned int>(_text, 0, UINT_MAX); }
+        inline void parseValue(const char* _text, long long& _value){ _value = static_cast<long long>(parseInteger<unsigned long long>(_text, static_cast<unsigned long long>(LLONG_MIN), LLONG_MAX)); }
+        inline void parseValue(const char* _text, unsigned long long& _value){ _value = parseInteger<unsigned long long>(_text, 0, ULLONG_MAX); }
+        // Only the first character counts, whitespace included
+        inline void parseValue(const char* _text, bool& _value){
+            _value = (*_text == '1' || *_text == 't' || *_text == 'T' || *_text == 'y' || *_text == 'Y');
+        }
+        inline void parseValue(const char* _text, std::string& _value){ _value = _text; }
+        inline void parseValue(const char* _text, const char*& _value){ _value = _text; }
+    }
+
+    template<typename TYPE>
+    inline bool getNodeValue(const FrozenNode& _node, TYPE& _value){
+        if(!_node) return false;
+        if(const char* text = _node.text(nullptr)) frozen::parseValue(text, _value);
+        return true;
+    }
+
+    // Base types
+    template<typename TYPE>
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, TYPE& _value, const TYPE* _defaultValue=nullptr){
+        if(_attributeName==nullptr || _attributeName[0]==0) _attributeName = "value"; // same fallback as setNodeAttribute()
+        if(const char* attr = _node.attribute(_attributeName)){
+            frozen::parseValue(attr, _value);
+            return true;
+        }
+        (void)_defaultValue; // like the pugi version, a missing attribute leaves _value untouched
+        return false;
+    }
+
+    // Custom types
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, glm::vec2& _value, const glm::vec2* _defaultValue=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<float>(_node, name.with("x"), _value.x, _defaultValue ? &_defaultValue->x : &_value.x);
+        ret *= getNodeAttributeValue<float>(_node, name.with("y"), _value.y, _defaultValue ? &_defaultValue->y : &_value.y);
+        return ret;
+    }
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, glm::vec3& _value, const glm::vec3* _defaultValue=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<float>(_node, name.with("x"), _value.x, _defaultValue ? &_defaultValue->x : &_value.x);
+        ret *= getNodeAttributeValue<float>(_node, name.with("y"), _value.y, _defaultValue ? &_defaultValue->y : &_value.y);
+        ret *= getNodeAttributeValue<float>(_node, name.with("z"), _value.z, _defaultValue ? &_defaultValue->z : &_value.z);
+        return ret;
+    }
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, glm::ivec2& _value, const glm::ivec2* _defaultValue=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<int>(_node, name.with("x"), _value.x, _defaultValue ? &_defaultValue->x : &_value.x);
+        ret *= getNodeAttributeValue<int>(_node, name.with("y"), _value.y, _defaultValue ? &_defaultValue->y : &_value.y);
+        return ret;
+    }
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, glm::vec4& _value, const glm::vec4* _defaultValue=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<float>(_node, name.with("x"), _value.x, _defaultValue ? &_defaultValue->x : &_value.x);
+        ret *= getNodeAttributeValue<float>(_node, name.with("y"), _value.y, _defaultValue ? &_defaultValue->y : &_value.y);
+        ret *= getNodeAttributeValue<float>(_node, name.with("z"), _value.z, _defaultValue ? &_defaultValue->z : &_value.z);
+        ret *= getNodeAttributeValue<float>(_node, name.with("w"), _value.w, _defaultValue ? &_defaultValue->w : &_value.w);
+        return ret;
+    }
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, ofFloatColor& _value, const ofFloatColor* _defaultValue=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<float>(_node, name.with("r"), _value.r, _defaultValue ? &_defaultValue->r : &_value.r);
+        ret *= getNodeAttributeValue<float>(_node, name.with("g"), _value.g, _defaultValue ? &_defaultValue->g : &_value.g);
+        ret *= getNodeAttributeValue<float>(_node, name.with("b"), _value.b, _defaultValue ? &_defaultValue->b : &_value.b);
+        ret *= getNodeAttributeValue<float>(_node, name.with("a"), _value.a, _defaultValue ? &_defaultValue->a : &_value.a);
+        return ret;
+    }
+    template<typename TYPE>
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, TYPE (&_value)[2], const TYPE (*_defaultValue)[2]=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v0"), _value[0], _defaultValue ? &(*_defaultValue)[0] : &_value[0]);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v1"), _value[1], _defaultValue ? &(*_defaultValue)[1] : &_value[1]);
+        return ret;
+    }
+    template<typename TYPE>
+    inline bool getNodeAttributeValue(const FrozenNode& _node, const char* _attributeName, TYPE (&_value)[4], const TYPE (*_defaultValue)[4]=nullptr){
+        bool ret = true;
+        AttrName name(_attributeName);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v0"), _value[0], _defaultValue ? &(*_defaultValue)[0] : &_value[0]);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v1"), _value[1], _defaultValue ? &(*_defaultValue)[1] : &_value[1]);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v2"), _value[2], _defaultValue ? &(*_defaultValue)[2] : &_value[2]);
+        ret *= getNodeAttributeValue<TYPE>(_node, name.with("v3"), _value[3], _defaultValue ? &(*_defaultValue)[3] : &_value[3]);
+        return ret;
+    }
+
+    template<typename TYPE>
+    inline bool getNodeValueFromAttribute(const FrozenNode& _parent, const char* _childName, TYPE& _value, const char* _attrName=""){
+        if(FrozenNode node = _parent.child(_childName)){
+            return getNodeAttributeValue(node, _attrName, _value);
+        }
+        return false;
+    }
+}
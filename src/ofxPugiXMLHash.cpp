@@ -0,0 +1,186 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofxPugiXMLHash.h"
+#include <cstring>
+
+namespace ofxPugiXml {
+
+namespace {
+
+    const std::uint64_t fnvOffset = 14695981039346656037ULL;
+    const std::uint64_t fnvPrime = 1099511628211ULL;
+
+    inline std::uint64_t mix(std::uint64_t x){
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    inline std::uint64_t combine(std::uint64_t seed, std::uint64_t value){
+        return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+    }
+
+    std::uint64_t hashString(const char* text){
+        std::uint64_t hash = fnvOffset;
+        for(; *text != 0; ++text){
+            hash ^= static_cast<unsigned char>(*text);
+            hash *= fnvPrime;
+        }
+        return hash;
+    }
+
+    inline bool isSpace(char c){
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool isWhitespaceText(const pugi::xml_node& node){
+        if(node.type() != pugi::node_pcdata) return false;
+        for(const char* text = node.value(); *text != 0; ++text){
+            if(!isSpace(*text)) return false;
+        }
+        return true;
+    }
+
+    // Type, name, value and attributes (order independent). Values of both are normalized.
+    std::uint64_t hashShallow(const pugi::xml_node& node){
+        std::uint64_t hash = mix(static_cast<std::uint64_t>(node.type()) + 1);
+        hash = combine(hash, hashString(node.name()));
+        hash = combine(hash, hashText(node.value()));
+        std::uint64_t attributes = 0;
+        for(pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute()){
+            attributes += mix(combine(hashString(attr.name()), hashText(attr.value())));
+        }
+        return combine(hash, attributes);
+    }
+
+    // Keeps 0 for null nodes
+    inline std::uint64_t finalize(std::uint64_t hash){
+        return hash == 0 ? 1 : hash;
+    }
+}
+
+std::uint64_t hashText(const char* _text){
+    std::uint64_t hash = fnvOffset;
+    bool started = false;
+    bool pendingSpace = false;
+    for(; *_text != 0; ++_text){
+        if(isSpace(*_text)){
+            pendingSpace = started;
+            continue;
+        }
+        if(pendingSpace){
+            hash ^= static_cast<unsigned char>(' ');
+            hash *= fnvPrime;
+            pendingSpace = false;
+        }
+        hash ^= static_cast<unsigned char>(*_text);
+        hash *= fnvPrime;
+        started = true;
+    }
+    return hash;
+}
+
+std::uint64_t hashBytes(const void* _data, std::size_t _size){
+    const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+    std::uint64_t hash = fnvOffset;
+    std::size_t i = 0;
+    for(; i + 8 <= _size; i += 8){
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 32;
+    }
+    std::uint64_t tail = 0;
+    for(std::size_t shift = 0; i < _size; ++i, shift += 8) tail |= std::uint64_t(bytes[i]) << shift;
+    return mix(hash ^ mix(tail ^ _size));
+}
+
+std::uint64_t hashNode(const pugi::xml_node& _node){
+    if(!_node) return 0;
+    std::uint64_t hash = hashShallow(_node);
+    for(pugi::xml_node child = _node.first_child(); child; child = child.next_sibling()){
+        if(isWhitespaceText(child)) continue;
+        hash = combine(hash, hashNode(child));
+    }
+    return finalize(hash);
+}
+
+// HashCache
+std::uint64_t HashCache::getHash(const pugi::xml_node& _node){
+    if(!_node) return 0;
+    // Text is hashed on the fly, so setting the text of a tag only needs to invalidate the tag
+    if(_node.type() == pugi::node_pcdata || _node.type() == pugi::node_cdata) return hashNode(_node);
+
+    auto found = hashes.find(_node.internal_object());
+    if(found != hashes.end()){
+        stats.hits++;
+        return found->second;
+    }
+
+    // Same as hashNode(), unchanged children come from the cache
+    std::uint64_t hash = hashShallow(_node);
+    for(pugi::xml_node child = _node.first_child(); child; child = child.next_sibling()){
+        if(isWhitespaceText(child)) continue;
+        hash = combine(hash, getHash(child));
+    }
+    hash = finalize(hash);
+    hashes.emplace(_node.internal_object(), hash);
+    stats.numHashed++;
+    return hash;
+}
+
+void HashCache::invalidate(const pugi::xml_node& _node){
+    hashes.erase(_node.internal_object());
+    // _node can be new, but ancestors of an uncached ancestor aren't cached either (see the invariant)
+    for(pugi::xml_node node = _node.parent(); node; node = node.parent()){
+        if(hashes.erase(node.internal_object()) == 0) break;
+    }
+}
+
+void HashCache::invalidateSubtree(const pugi::xml_node& _node){
+    if(!_node) return;
+    invalidate(_node);
+    // Iterative pre-order walk of the descendants
+    pugi::xml_node node = _node.first_child();
+    while(node){
+        hashes.erase(node.internal_object());
+        if(node.first_child()){
+            node = node.first_child();
+            continue;
+        }
+        while(node && node != _node && !node.next_sibling()) node = node.parent();
+        if(!node || node == _node) break;
+        node = node.next_sibling();
+    }
+}
+
+void HashCache::clear(){
+    hashes.clear();
+}
+
+}
@@ -0,0 +1,81 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace ofxPugiXml {
+
+    // Subtree content hashes
+    // Stable 64-bit hash of a node and all its descendants : the same content gives the same hash across runs and platforms.
+    // It covers node types, names, values and attributes, and is normalized so that formatting doesn't count :
+    // - attribute order is ignored,
+    // - leading/trailing whitespace of values (text and attributes) is ignored, inner whitespace runs count as one space,
+    // - whitespace-only text nodes (parse_ws_pcdata) are ignored.
+    // Returns 0 for a null node, never for a valid one.
+    std::uint64_t hashNode(const pugi::xml_node& _node);
+
+    // Hash of a value, with the above whitespace normalization
+    std::uint64_t hashText(const char* _text);
+
+    // Stable hash of raw bytes (file contents...), processed 8 bytes at a time
+    std::uint64_t hashBytes(const void* _data, std::size_t _size);
+
+    // Memoized subtree hashes
+    // Once a subtree is hashed, asking again costs a lookup, so "has this changed ?" is a single comparison.
+    // After modifying a node, call invalidate() on it (its ancestors are invalidated too).
+    // Text nodes aren't cached : after changing the text of a tag, invalidate the tag.
+    // Before removing a node, call invalidateSubtree() on it : pugi reuses the memory of removed nodes.
+    // Usage :
+    //     std::uint64_t hash = cache.getHash(shaderNode);
+    //     if(hash != shaderHash){ shaderHash = hash; rebuildShader(); }
+    class HashCache {
+    public:
+        std::uint64_t getHash(const pugi::xml_node& _node);
+
+        void invalidate(const pugi::xml_node& _node);
+        void invalidateSubtree(const pugi::xml_node& _node);
+        void clear();
+
+        std::size_t size() const { return hashes.size(); }
+
+        struct Stats {
+            std::size_t hits = 0;
+            std::size_t numHashed = 0; // nodes (re)hashed
+        };
+        const Stats& getStats() const { return stats; }
+        void resetStats(){ stats = Stats(); }
+
+    private:
+        // Invariant : when a node is cached, all its descendants are too
+        std::unordered_map<const pugi::xml_node_struct*, std::uint64_t> hashes;
+        Stats stats;
+    };
+}
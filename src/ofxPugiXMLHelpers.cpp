@@ -27,4 +27,307 @@
 // To be used optionally with pugixml.hpp. Maybe use always with ofxPugiXML.h ?
 
 #include "ofxPugiXMLHelpers.h"
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <type_traits>
+#include <sstream>
+#include <locale>
 
+// <charconv> is C++17, and its floating point part isn't available everywhere yet (older libc++ / libstdc++).
+// __cpp_lib_to_chars is only defined once both integers and floats are supported, otherwise fall back to the C functions.
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <charconv>
+#endif
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define ofxPugiXML_CHARCONV
+#endif
+
+// The C functions follow the app's locale (a German locale reads "1.5" as 1) : parse with a "C" locale object.
+#ifndef ofxPugiXML_CHARCONV
+#if defined(_WIN32)
+#define ofxPugiXML_STRTOD_L
+typedef _locale_t ofxPugiXmlLocale;
+static ofxPugiXmlLocale createCLocale(){ return _create_locale(LC_NUMERIC, "C"); }
+static double strtodC(const char* _text, char** _end, ofxPugiXmlLocale _locale){ return _strtod_l(_text, _end, _locale); }
+#elif defined(__APPLE__) || defined(__GLIBC__) || defined(__FreeBSD__)
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#define ofxPugiXML_STRTOD_L
+typedef locale_t ofxPugiXmlLocale;
+static ofxPugiXmlLocale createCLocale(){ return newlocale(LC_NUMERIC_MASK, "C", (locale_t)0); }
+static double strtodC(const char* _text, char** _end, ofxPugiXmlLocale _locale){ return strtod_l(_text, _end, _locale); }
+#endif
+#endif
+
+namespace ofxPugiXml {
+
+#ifdef ofxPugiXML_CHARCONV
+template<typename TYPE>
+static inline std::size_t integerToChars(char* _buffer, std::size_t _size, TYPE _value){
+    std::to_chars_result result = std::to_chars(_buffer, _buffer + _size, _value);
+    if(result.ec != std::errc()) return 0;
+    return result.ptr - _buffer;
+}
+
+template<typename TYPE>
+static inline const char* charsToInteger(const char* _text, const char* _end, TYPE& _value){
+    // from_chars doesn't accept a leading +
+    if(_text != _end && *_text == '+') ++_text;
+    std::from_chars_result result = std::from_chars(_text, _end, _value);
+    if(result.ec != std::errc()) return nullptr;
+    return result.ptr;
+}
+
+template<typename TYPE>
+static inline std::size_t floatToChars(char* _buffer, std::size_t _size, TYPE _value, const char*){
+    // Shortest representation that round-trips
+    std::to_chars_result result = std::to_chars(_buffer, _buffer + _size, _value);
+    if(result.ec != std::errc()) return 0;
+    return result.ptr - _buffer;
+}
+
+template<typename TYPE>
+static inline const char* charsToFloat(const char* _text, const char* _end, TYPE& _value){
+    if(_text != _end && *_text == '+') ++_text;
+    std::from_chars_result result = std::from_chars(_text, _end, _value);
+    if(result.ec != std::errc()) return nullptr;
+    return result.ptr;
+}
+#else
+static inline std::size_t integerToChars(char* _buffer, std::size_t _size, long long _value){
+    const int written = std::snprintf(_buffer, _size, "%lld", _value);
+    if(written < 0 || static_cast<std::size_t>(written) >= _size) return 0;
+    return written;
+}
+
+// Same rules as from_chars : decimal only, in range, and a sign only where the type has one
+template<typename TYPE>
+static inline const char* charsToInteger(const char* _text, const char* _end, TYPE& _value){
+    // Text nodes are null-terminated, strtoll stops at the first separator
+    (void)_end;
+    if(*_text == '+') ++_text;
+    if((*_text < '0' || *_text > '9') && (*_text != '-' || !std::is_signed<TYPE>::value)) return nullptr;
+    char* parsed = nullptr;
+    errno = 0;
+    const long long value = std::strtoll(_text, &parsed, 10);
+    if(parsed == _text || errno == ERANGE) return nullptr;
+    if(value < static_cast<long long>(std::numeric_limits<TYPE>::min()) || value > static_cast<long long>(std::numeric_limits<TYPE>::max())) return nullptr;
+    _value = static_cast<TYPE>(value);
+    return parsed;
+}
+
+template<typename TYPE>
+static inline std::size_t floatToChars(char* _buffer, std::size_t _size, TYPE _value, const char* _format){
+    const int written = std::snprintf(_buffer, _size, _format, _value);
+    if(written < 0 || static_cast<std::size_t>(written) >= _size) return 0;
+    // snprintf writes the locale's decimal point
+    const char decimalPoint = *std::localeconv()->decimal_point;
+    if(decimalPoint != '.'){
+        for(int i = 0; i < written; ++i) if(_buffer[i] == decimalPoint) _buffer[i] = '.';
+    }
+    return written;
+}
+
+template<typename TYPE>
+static inline const char* charsToFloat(const char* _text, const char* _end, TYPE& _value){
+    // Text nodes are null-terminated, strtod stops at the first separator
+    (void)_end;
+    char* parsed = nullptr;
+#ifdef ofxPugiXML_STRTOD_L
+    static const ofxPugiXmlLocale cLocale = createCLocale();
+    _value = static_cast<TYPE>(strtodC(_text, &parsed, cLocale));
+    if(parsed == _text) return nullptr;
+    return parsed;
+#else
+    std::istringstream stream(std::string(_text, std::strcspn(_text, " ,\n\t\r")));
+    stream.imbue(std::locale::classic());
+    double value = 0;
+    if(!(stream >> value)) return nullptr;
+    _value = static_cast<TYPE>(value);
+    const std::streamoff consumed = stream.eof() ? static_cast<std::streamoff>(stream.str().size()) : static_cast<std::streamoff>(stream.tellg());
+    return _text + consumed;
+#endif
+}
+#endif
+
+std::size_t numberToChars(char* _buffer, std::size_t _size, float _value){
+    return floatToChars(_buffer, _size, _value, "%.9g");
+}
+std::size_t numberToChars(char* _buffer, std::size_t _size, double _value){
+    return floatToChars(_buffer, _size, _value, "%.17g");
+}
+std::size_t numberToChars(char* _buffer, std::size_t _size, int _value){
+    return integerToChars(_buffer, _size, _value);
+}
+std::size_t numberToChars(char* _buffer, std::size_t _size, unsigned int _value){
+    return integerToChars(_buffer, _size, _value);
+}
+std::size_t numberToChars(char* _buffer, std::size_t _size, long long _value){
+    return integerToChars(_buffer, _size, _value);
+}
+
+const char* charsToNumber(const char* _text, const char* _end, float& _value){
+    return charsToFloat(_text, _end, _value);
+}
+const char* charsToNumber(const char* _text, const char* _end, double& _value){
+    return charsToFloat(_text, _end, _value);
+}
+const char* charsToNumber(const char* _text, const char* _end, int& _value){
+    return charsToInteger(_text, _end, _value);
+}
+const char* charsToNumber(const char* _text, const char* _end, unsigned int& _value){
+    return charsToInteger(_text, _end, _value);
+}
+const char* charsToNumber(const char* _text, const char* _end, long long& _value){
+    return charsToInteger(_text, _end, _value);
+}
+
+//--------------------------------------------------------------
+// Base64 codec
+// Encoding looks up 12 bits at a time (two output chars per lookup).
+// Decoding handles 4 chars per iteration and only takes the slow path for whitespace, padding or errors.
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Decoding table : 0-63 are values, base64Skip is whitespace, base64Invalid anything else.
+static const std::uint8_t base64Skip = 0x40;
+static const std::uint8_t base64Invalid = 0x80;
+
+struct Base64Tables {
+    char pairs[4096][2];
+    std::uint8_t values[256];
+    Base64Tables(){
+        for(int i = 0; i < 4096; ++i){
+            pairs[i][0] = base64Chars[i >> 6];
+            pairs[i][1] = base64Chars[i & 0x3F];
+        }
+        for(int i = 0; i < 256; ++i) values[i] = base64Invalid;
+        for(int i = 0; i < 64; ++i) values[static_cast<unsigned char>(base64Chars[i])] = static_cast<std::uint8_t>(i);
+        values[static_cast<unsigned char>(' ')] = base64Skip;
+        values[static_cast<unsigned char>('\n')] = base64Skip;
+        values[static_cast<unsigned char>('\r')] = base64Skip;
+        values[static_cast<unsigned char>('\t')] = base64Skip;
+    }
+};
+
+static const Base64Tables& getBase64Tables(){
+    static const Base64Tables tables;
+    return tables;
+}
+
+bool setNodeBinary(pugi::xml_node& _node, const void* _data, std::size_t _size){
+    if(!_node) return false;
+    if(_data == nullptr && _size > 0) return false;
+
+    const Base64Tables& tables = getBase64Tables();
+    const std::uint8_t* in = static_cast<const std::uint8_t*>(_data);
+    std::string text((_size + 2) / 3 * 4, '=');
+    char* out = &text[0];
+
+    std::size_t i = 0;
+    for(; i + 3 <= _size; i += 3){
+        const std::uint32_t triple = (std::uint32_t(in[i]) << 16) | (std::uint32_t(in[i+1]) << 8) | in[i+2];
+        std::memcpy(out, tables.pairs[triple >> 12], 2);
+        std::memcpy(out + 2, tables.pairs[triple & 0xFFF], 2);
+        out += 4;
+    }
+    // Tail, padding is already there
+    if(i < _size){
+        std::uint32_t triple = std::uint32_t(in[i]) << 16;
+        if(i + 1 < _size) triple |= std::uint32_t(in[i+1]) << 8;
+        out[0] = base64Chars[(triple >> 18) & 0x3F];
+        out[1] = base64Chars[(triple >> 12) & 0x3F];
+        if(i + 1 < _size) out[2] = base64Chars[(triple >> 6) & 0x3F];
+    }
+
+    return _node.text().set(text.c_str());
+}
+
+std::size_t getNodeBinarySize(const pugi::xml_node& _node){
+    if(!_node) return 0;
+    const Base64Tables& tables = getBase64Tables();
+    std::size_t chars = 0;
+    for(const char* c = _node.text().get(); *c != 0; ++c){
+        if(tables.values[static_cast<unsigned char>(*c)] < 64) ++chars;
+    }
+    // Padding isn't needed to know the size, unpadded payloads are accepted too
+    return chars / 4 * 3 + ((chars % 4) > 1 ? (chars % 4) - 1 : 0);
+}
+
+bool getNodeBinary(const pugi::xml_node& _node, void* _data, std::size_t _capacity, std::size_t& _decodedSize){
+    _decodedSize = 0;
+    if(!_node) return false;
+
+    const std::uint8_t* values = getBase64Tables().values;
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(_node.text().get());
+    std::uint8_t* out = static_cast<std::uint8_t*>(_data);
+    std::uint8_t* const outEnd = out + _capacity;
+
+    std::uint32_t quad = 0;
+    int quadChars = 0;
+    while(true){
+        // Fast path : 4 significant chars at once
+        if(quadChars == 0 && outEnd - out >= 3){
+            const std::uint8_t a = values[in[0]];
+            if(a < 64){
+                const std::uint8_t b = values[in[1]];
+                const std::uint8_t c = (b < 64) ? values[in[2]] : base64Invalid;
+                const std::uint8_t d = (c < 64) ? values[in[3]] : base64Invalid;
+                if(d < 64){
+                    const std::uint32_t triple = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6) | d;
+                    out[0] = static_cast<std::uint8_t>(triple >> 16);
+                    out[1] = static_cast<std::uint8_t>(triple >> 8);
+                    out[2] = static_cast<std::uint8_t>(triple);
+                    out += 3;
+                    in += 4;
+                    continue;
+                }
+            }
+        }
+
+        // Slow path : one char at a time
+        const unsigned char c = *in;
+        if(c == 0 || c == '=') break;
+        ++in;
+        const std::uint8_t value = values[c];
+        if(value == base64Skip) continue;
+        if(value == base64Invalid) return false;
+
+        quad = (quad << 6) | value;
+        if(++quadChars == 4){
+            if(outEnd - out < 3) return false;
+            out[0] = static_cast<std::uint8_t>(quad >> 16);
+            out[1] = static_cast<std::uint8_t>(quad >> 8);
+            out[2] = static_cast<std::uint8_t>(quad);
+            out += 3;
+            quad = 0;
+            quadChars = 0;
+        }
+    }
+
+    // Remaining chars (padded or not)
+    if(quadChars == 1) return false;
+    if(quadChars > 1){
+        const std::size_t tailBytes = quadChars - 1;
+        if(static_cast<std::size_t>(outEnd - out) < tailBytes) return false;
+        quad <<= 6 * (4 - quadChars);
+        out[0] = static_cast<std::uint8_t>(quad >> 16);
+        if(tailBytes > 1) out[1] = static_cast<std::uint8_t>(quad >> 8);
+        out += tailBytes;
+    }
+
+    // Only padding and whitespace may follow
+    for(; *in != 0; ++in){
+        if(*in != '=' && values[*in] != base64Skip) return false;
+    }
+
+    _decodedSize = out - static_cast<std::uint8_t*>(_data);
+    return true;
+}
+
+} // namespace ofxPugiXml
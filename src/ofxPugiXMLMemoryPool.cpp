@@ -0,0 +1,332 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLMemoryPool.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+namespace ofxPugiXml {
+
+    namespace {
+
+        // Stored right before each block, keeps the block's natural alignment
+        struct alignas(alignof(std::max_align_t)) BlockHeader {
+            std::size_t sizeClass;
+            std::size_t size; // requested size
+        };
+
+        const std::size_t minBlockShift = 6; // 64 bytes
+        const std::size_t numSizeClasses = 1 + (sizeof(std::size_t) * 8 - minBlockShift) * 4;
+
+        // Blocks of a size class : 64, then 4 classes per power of two (80, 96, 112, 128, 160, ...)
+        std::size_t getSizeClass(std::size_t _size, std::size_t& _blockSize){
+            if(_size <= (std::size_t(1) << minBlockShift)){
+                _blockSize = std::size_t(1) << minBlockShift;
+                return 0;
+            }
+            std::size_t shift = minBlockShift;
+            while((_size - 1) >> (shift + 1)) ++shift;
+            const std::size_t base = std::size_t(1) << shift;
+            const std::size_t step = base / 4;
+            const std::size_t quarter = (_size - 1 - base) / step;
+            _blockSize = base + (quarter + 1) * step;
+            return 1 + (shift - minBlockShift) * 4 + quarter;
+        }
+        std::size_t getBlockSize(std::size_t _sizeClass){
+            if(_sizeClass == 0) return std::size_t(1) << minBlockShift;
+            const std::size_t base = std::size_t(1) << (minBlockShift + (_sizeClass - 1) / 4);
+            return base + ((_sizeClass - 1) % 4 + 1) * (base / 4);
+        }
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        // Per thread cache limits, and how many blocks move at once between a thread and the shared pool
+        const std::size_t maxThreadBlocks = 64;
+        const std::size_t maxThreadBytes = 4 << 20;
+        const std::size_t numTransferBlocks = 16;
+
+        // Free blocks shared by all threads
+        struct SharedPool {
+            std::mutex mutex;
+            FreeBlock* freeLists[numSizeClasses] = {};
+            std::size_t cached = 0;
+            bool installed = false;
+        };
+
+        // Never destroyed : pugixml may free memory after static destruction started (global documents)
+        SharedPool& getSharedPool(){
+            static SharedPool* pool = new SharedPool();
+            return *pool;
+        }
+
+        // Relaxed counters, for the stats only
+        struct Counters {
+            std::atomic<std::size_t> reserved{0};
+            std::atomic<std::size_t> used{0};
+            std::atomic<std::size_t> highWater{0};
+            std::atomic<std::size_t> numAllocations{0};
+            std::atomic<std::size_t> numReused{0};
+            std::atomic<std::size_t> numBlocksInUse{0};
+        };
+        Counters counters;
+
+        // Trivially destructible, so it stays usable after the flusher below ran at thread exit
+        struct ThreadCache {
+            FreeBlock* freeLists[numSizeClasses];
+            std::size_t numBlocks[numSizeClasses];
+            std::size_t cached;
+            bool hasFlusher;
+            bool finished; // the thread is exiting : go to the shared pool directly
+        };
+        thread_local ThreadCache threadCache = {};
+
+        // Pushes _count blocks of a list to the shared pool. _first..._last are linked.
+        void pushShared(std::size_t _sizeClass, FreeBlock* _first, FreeBlock* _last, std::size_t _count){
+            SharedPool& pool = getSharedPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            _last->next = pool.freeLists[_sizeClass];
+            pool.freeLists[_sizeClass] = _first;
+            pool.cached += _count * getBlockSize(_sizeClass);
+        }
+
+        // Moves the first _count blocks of a thread list to the shared pool
+        void releaseThreadBlocks(ThreadCache& _cache, std::size_t _sizeClass, std::size_t _count){
+            FreeBlock* first = _cache.freeLists[_sizeClass];
+            if(first == nullptr || _count == 0) return;
+            FreeBlock* last = first;
+            std::size_t numMoved = 1;
+            while(numMoved < _count && last->next != nullptr){
+                last = last->next;
+                ++numMoved;
+            }
+            _cache.freeLists[_sizeClass] = last->next;
+            _cache.numBlocks[_sizeClass] -= numMoved;
+            _cache.cached -= numMoved * getBlockSize(_sizeClass);
+            pushShared(_sizeClass, first, last, numMoved);
+        }
+
+        void releaseThreadCache(ThreadCache& _cache){
+            for(std::size_t sizeClass = 0; sizeClass < numSizeClasses; ++sizeClass){
+                releaseThreadBlocks(_cache, sizeClass, _cache.numBlocks[sizeClass]);
+            }
+        }
+
+        // Returns the cached blocks of an exiting thread
+        struct ThreadCacheFlusher {
+            bool isUsed = false;
+            ~ThreadCacheFlusher(){
+                threadCache.finished = true;
+                releaseThreadCache(threadCache);
+            }
+        };
+        thread_local ThreadCacheFlusher threadCacheFlusher;
+
+        // Takes up to numTransferBlocks from the shared pool : returns one, caches the others in the thread
+        FreeBlock* takeShared(ThreadCache& _cache, std::size_t _sizeClass){
+            SharedPool& pool = getSharedPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            FreeBlock* block = pool.freeLists[_sizeClass];
+            if(block == nullptr) return nullptr;
+            pool.freeLists[_sizeClass] = block->next;
+            std::size_t numTaken = 1;
+            if(!_cache.finished){
+                while(numTaken < numTransferBlocks && pool.freeLists[_sizeClass] != nullptr){
+                    FreeBlock* extra = pool.freeLists[_sizeClass];
+                    pool.freeLists[_sizeClass] = extra->next;
+                    extra->next = _cache.freeLists[_sizeClass];
+                    _cache.freeLists[_sizeClass] = extra;
+                    _cache.numBlocks[_sizeClass]++;
+                    ++numTaken;
+                }
+                _cache.cached += (numTaken - 1) * getBlockSize(_sizeClass);
+            }
+            pool.cached -= numTaken * getBlockSize(_sizeClass);
+            return block;
+        }
+
+        // The functions install() replaced, restored by uninstall()
+        pugi::allocation_function previousAllocate = nullptr;
+        pugi::deallocation_function previousDeallocate = nullptr;
+
+#ifdef ofxPugiXML_MEMORYPOOL_CHECKS
+        // Opt-in : replaces pugixml's default allocator during static initialization with one counting its blocks
+        // in use, so install() can refuse while some exist.
+        std::atomic<std::ptrdiff_t> numDefaultBlocksInUse{0};
+        void* defaultAllocate(std::size_t _size){
+            void* block = std::malloc(_size);
+            if(block != nullptr) numDefaultBlocksInUse.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+        void defaultDeallocate(void* _ptr){
+            if(_ptr == nullptr) return;
+            numDefaultBlocksInUse.fetch_sub(1, std::memory_order_relaxed);
+            std::free(_ptr);
+        }
+        struct DefaultAllocatorInstaller {
+            DefaultAllocatorInstaller(){
+                pugi::set_memory_management_functions(&defaultAllocate, &defaultDeallocate);
+            }
+        };
+        DefaultAllocatorInstaller defaultAllocatorInstaller;
+#endif
+    }
+
+    bool MemoryPool::install(){
+        SharedPool& pool = getSharedPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if(pool.installed) return false;
+#ifdef ofxPugiXML_MEMORYPOOL_CHECKS
+        // Someone else's allocator, or blocks we couldn't free
+        if(pugi::get_memory_allocation_function() != &defaultAllocate) return false;
+        if(numDefaultBlocksInUse.load(std::memory_order_relaxed) > 0) return false;
+#endif
+
+        previousAllocate = pugi::get_memory_allocation_function();
+        previousDeallocate = pugi::get_memory_deallocation_function();
+        pool.installed = true;
+        pugi::set_memory_management_functions(&MemoryPool::allocate, &MemoryPool::deallocate);
+        return true;
+    }
+
+    bool MemoryPool::uninstall(){
+        {
+            SharedPool& pool = getSharedPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if(!pool.installed || counters.numBlocksInUse.load(std::memory_order_relaxed) > 0) return false;
+            pool.installed = false;
+            pugi::set_memory_management_functions(previousAllocate, previousDeallocate);
+        }
+        trim();
+        return true;
+    }
+
+    bool MemoryPool::isInstalled(){
+        SharedPool& pool = getSharedPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        return pool.installed;
+    }
+
+    void* MemoryPool::allocate(std::size_t _size){
+        std::size_t blockSize = 0;
+        const std::size_t sizeClass = getSizeClass(_size, blockSize);
+        counters.numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        ThreadCache& cache = threadCache;
+        FreeBlock* block = cache.freeLists[sizeClass];
+        if(block != nullptr){
+            cache.freeLists[sizeClass] = block->next;
+            cache.numBlocks[sizeClass]--;
+            cache.cached -= blockSize;
+        }
+        else {
+            block = takeShared(cache, sizeClass);
+        }
+
+        BlockHeader* header = nullptr;
+        if(block != nullptr){
+            counters.numReused.fetch_add(1, std::memory_order_relaxed);
+            header = reinterpret_cast<BlockHeader*>(block) - 1;
+        }
+        else {
+            if(blockSize > SIZE_MAX - sizeof(BlockHeader)) return nullptr;
+            header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + blockSize));
+            if(header == nullptr) return nullptr;
+            header->sizeClass = sizeClass;
+            counters.reserved.fetch_add(blockSize, std::memory_order_relaxed);
+        }
+        header->size = _size;
+
+        counters.numBlocksInUse.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t used = counters.used.fetch_add(_size, std::memory_order_relaxed) + _size;
+        std::size_t highWater = counters.highWater.load(std::memory_order_relaxed);
+        while(used > highWater && !counters.highWater.compare_exchange_weak(highWater, used, std::memory_order_relaxed)){}
+        return header + 1;
+    }
+
+    void MemoryPool::deallocate(void* _ptr){
+        if(_ptr == nullptr) return;
+        const BlockHeader* header = static_cast<const BlockHeader*>(_ptr) - 1;
+        const std::size_t sizeClass = header->sizeClass;
+        counters.used.fetch_sub(header->size, std::memory_order_relaxed);
+        counters.numBlocksInUse.fetch_sub(1, std::memory_order_relaxed);
+
+        // The free list link lives in the (unused) block memory
+        FreeBlock* block = static_cast<FreeBlock*>(_ptr);
+        ThreadCache& cache = threadCache;
+        if(cache.finished){
+            pushShared(sizeClass, block, block, 1);
+            return;
+        }
+        if(!cache.hasFlusher){
+            // First block kept by this thread : make sure it's returned when the thread ends
+            cache.hasFlusher = true;
+            threadCacheFlusher.isUsed = true;
+        }
+        block->next = cache.freeLists[sizeClass];
+        cache.freeLists[sizeClass] = block;
+        cache.numBlocks[sizeClass]++;
+        cache.cached += getBlockSize(sizeClass);
+
+        // Keep the thread caches small : big blocks (file buffers) and surplus go to the shared pool
+        if(cache.cached > maxThreadBytes) releaseThreadBlocks(cache, sizeClass, cache.numBlocks[sizeClass]);
+        else if(cache.numBlocks[sizeClass] > maxThreadBlocks) releaseThreadBlocks(cache, sizeClass, maxThreadBlocks / 2);
+    }
+
+    void MemoryPool::trim(std::size_t _keepBytes){
+        releaseThreadCache(threadCache);
+
+        SharedPool& pool = getSharedPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        // Largest blocks first
+        for(std::size_t sizeClass = numSizeClasses; sizeClass-- > 0 && pool.cached > _keepBytes;){
+            const std::size_t blockSize = getBlockSize(sizeClass);
+            while(pool.freeLists[sizeClass] != nullptr && pool.cached > _keepBytes){
+                FreeBlock* block = pool.freeLists[sizeClass];
+                pool.freeLists[sizeClass] = block->next;
+                pool.cached -= blockSize;
+                counters.reserved.fetch_sub(blockSize, std::memory_order_relaxed);
+                std::free(reinterpret_cast<BlockHeader*>(block) - 1);
+            }
+        }
+    }
+
+    MemoryPool::Stats MemoryPool::getStats(){
+        Stats stats;
+        stats.reserved = counters.reserved.load(std::memory_order_relaxed);
+        stats.used = counters.used.load(std::memory_order_relaxed);
+        stats.highWater = counters.highWater.load(std::memory_order_relaxed);
+        stats.numAllocations = counters.numAllocations.load(std::memory_order_relaxed);
+        stats.numReused = counters.numReused.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void MemoryPool::resetHighWater(){
+        counters.highWater.store(counters.used.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,81 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <cstddef>
+
+namespace ofxPugiXml {
+
+    // Pooled allocator for pugixml
+    // pugixml allocates its nodes in pages (and file buffers in one block) and frees them all when a document is
+    // reset or reloaded. Installed, this pool keeps freed blocks in size classes (4 per power of two, at most 25%
+    // slack) and hands them out again, so reload-heavy workloads stop going through malloc/free.
+    // The pool is global (pugixml's allocator is) and thread safe : each thread keeps a small cache of free blocks
+    // (up to 64 per size class and 4MB), used without locking. Only cache misses and overflows go through the shared
+    // pool, in batches, so parallel loaders (ofxPugiXmlBatchLoader, ofxPugiXmlRecordSet) don't serialize on it.
+    // Install it before pugixml allocates anything : first thing in main(), with no document loaded yet (global or
+    // static ones included). The pool can't free blocks of the previous allocator, they must all be freed before.
+    // Define ofxPugiXML_MEMORYPOOL_CHECKS to have install() check it : pugixml's default allocator is then replaced
+    // during static initialization by one counting its blocks in use.
+    // Usage :
+    //     int main(){
+    //         ofxPugiXml::MemoryPool::install(); // before any pugixml allocation
+    //         ...
+    //     }
+    //     // Later, free the memory kept for reuse :
+    //     ofxPugiXml::MemoryPool::trim();
+    class MemoryPool {
+    public:
+        struct Stats {
+            std::size_t reserved = 0;  // bytes held by the pool (in use + cached)
+            std::size_t used = 0;      // bytes currently in use by pugixml
+            std::size_t highWater = 0; // highest `used` since install (or resetHighWater())
+            std::size_t numAllocations = 0;
+            std::size_t numReused = 0; // allocations served from the cache (no malloc)
+        };
+
+        // Sets the pool as pugixml's allocator. Returns false if it's already installed. With
+        // ofxPugiXML_MEMORYPOOL_CHECKS, also if pugixml uses other custom allocation functions, or if blocks of the
+        // default allocator are still in use.
+        static bool install();
+        // Restores the previous allocator and frees the shared cache. Returns false while pool blocks are in use.
+        // Call it while no other thread uses pugixml.
+        static bool uninstall();
+        static bool isInstalled();
+
+        // Frees the shared cache (and the calling thread's) until at most `keepBytes` are cached. Blocks in use are
+        // not affected, other threads' caches are returned to the shared pool when those threads end.
+        static void trim(std::size_t keepBytes = 0);
+
+        static Stats getStats();
+        static void resetHighWater();
+
+        // The allocation functions, if you need to chain them in a custom allocator
+        static void* allocate(std::size_t size);
+        static void deallocate(void* ptr);
+    };
+}
@@ -0,0 +1,98 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "ofxPugiXMLHelpers.h"
+#include <cstring>
+
+namespace ofxPugiXml {
+
+    // Reads the children of a node by name, remembering where the previous one was found.
+    // pugi's child(name) restarts from the first child, so reading N named children costs O(N^2).
+    // The reader tries the element following the previous match first and only scans all children when the order
+    // differs, so reading children in the order they were written is linear.
+    // Note: unlike child(name), a name found right after the cursor is returned even if an earlier child has
+    // the same name : reading repeated names in order gives each of them.
+    // Usage :
+    //     ofxPugiXml::NodeReader reader(node);
+    //     reader.getValueFromAttribute("position", position);
+    //     reader.getValueFromAttribute("color", color);
+    //     reader.getValue("name", name);
+    class NodeReader {
+    public:
+        explicit NodeReader(const pugi::xml_node& _parent) : parent(_parent) {}
+
+        pugi::xml_node child(const char* _name){
+            // Expected : the next element after the cursor
+            pugi::xml_node next = cursor ? cursor.next_sibling() : parent.first_child();
+            while(next && next.type() != pugi::node_element) next = next.next_sibling();
+            if(next && std::strcmp(next.name(), _name) == 0){
+                cursor = next;
+                return next;
+            }
+            // Out of order : full scan
+            numFallbacks++;
+            pugi::xml_node found = parent.child(_name);
+            if(found) cursor = found;
+            return found;
+        }
+
+        // Same as getNodeValue(parent, childName, value)
+        template<typename TYPE>
+        bool getValue(const char* _childName, TYPE& _value){
+            if(pugi::xml_node node = child(_childName)){
+                getNodeValue(node, _value);
+                return true;
+            }
+            return false;
+        }
+
+        // Same as getNodeValueFromAttribute(parent, childName, value, attrName)
+        template<typename TYPE>
+        bool getValueFromAttribute(const char* _childName, TYPE& _value, const char* _attrName = ""){
+            if(pugi::xml_node node = child(_childName)){
+                return getNodeAttributeValue(node, _attrName, _value);
+            }
+            return false;
+        }
+
+        // Restarts from the first child
+        void rewind(){ cursor = pugi::xml_node(); }
+        // Continues after _child (a child of the parent), e.g. after inserting it
+        void setCursor(const pugi::xml_node& _child){ cursor = _child; }
+
+        const pugi::xml_node& getParent() const { return parent; }
+        // The last found child
+        const pugi::xml_node& getCursor() const { return cursor; }
+        // Number of lookups that didn't find the expected child and scanned all children
+        std::size_t getNumFallbacks() const { return numFallbacks; }
+
+    protected:
+        pugi::xml_node parent;
+        pugi::xml_node cursor;
+        std::size_t numFallbacks = 0;
+    };
+}
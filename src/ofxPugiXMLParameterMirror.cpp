@@ -0,0 +1,164 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLParameterMirror.h"
+#include <chrono>
+
+ofxPugiXmlParameterMirror::ofxPugiXmlParameterMirror(){
+
+}
+
+ofxPugiXmlParameterMirror::~ofxPugiXmlParameterMirror(){
+    // The worker uses our bindings
+    if(this->flushJob.valid()) this->flushJob.wait();
+}
+
+ofxPugiXmlParameterMirror::Value* ofxPugiXmlParameterMirror::addBinding(const std::string& path, const std::uint32_t* lanes, std::size_t numLanes, WriteFunction write, ReadFunction read){
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for(const Binding& binding : this->bindings){
+        if(binding.path != path) continue;
+        // The functions are instantiated per type
+        return (binding.write == write) ? binding.value : nullptr;
+    }
+
+    Binding binding;
+    if(!ofxPugiXmlSettings::parsePath(path, binding.segments, binding.attribute) || binding.segments.empty()) return nullptr;
+    binding.path = path;
+    binding.numLanes = numLanes;
+    binding.write = write;
+    binding.read = read;
+
+    this->values.emplace_back();
+    binding.value = &this->values.back();
+    binding.value->store(lanes, numLanes);
+    this->bindings.push_back(std::move(binding));
+    return this->bindings.back().value;
+}
+
+std::size_t ofxPugiXmlParameterMirror::getNumBindings() const{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->bindings.size();
+}
+
+pugi::xml_node ofxPugiXmlParameterMirror::resolve(const pugi::xml_node& root, const Binding& binding){
+    pugi::xml_node node = root;
+    for(const ofxPugiXmlSettings::PathSegment& segment : binding.segments){
+        node = node.child(segment.name.c_str());
+        for(int i = 0; i < segment.which && node; ++i) node = node.next_sibling(segment.name.c_str());
+        if(!node) break;
+    }
+    return node;
+}
+
+pugi::xml_node ofxPugiXmlParameterMirror::resolveOrAppend(pugi::xml_node root, const Binding& binding){
+    pugi::xml_node node = root;
+    for(const ofxPugiXmlSettings::PathSegment& segment : binding.segments){
+        const char* name = segment.name.c_str();
+        pugi::xml_node child = node.child(name);
+        int index = 0;
+        while(child && index < segment.which){
+            child = child.next_sibling(name);
+            ++index;
+        }
+        // index is now the number of existing tags : append up to the requested one
+        for(; !child && index <= segment.which; ++index){
+            pugi::xml_node appended = node.append_child(name);
+            if(index == segment.which) child = appended;
+        }
+        if(!child) return pugi::xml_node();
+        node = child;
+    }
+    return node;
+}
+
+std::size_t ofxPugiXmlParameterMirror::load(const pugi::xml_node& root){
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::size_t numFound = 0;
+    std::uint32_t lanes[4];
+    for(Binding& binding : this->bindings){
+        binding.value->dirty.store(false, std::memory_order_relaxed);
+        pugi::xml_node node = resolve(root, binding);
+        if(!node) continue;
+        binding.value->load(lanes, binding.numLanes);
+        if(!binding.read(node, binding.attribute, lanes)) continue;
+        binding.value->store(lanes, binding.numLanes);
+        ++numFound;
+    }
+    return numFound;
+}
+
+std::size_t ofxPugiXmlParameterMirror::load(const ofxPugiXmlSharedSettings& shared){
+    // The pinned version stays valid while we read it
+    ofxPugiXmlSharedSettings::ReadSession session = shared.read();
+    return this->load(session.getCurrentNode());
+}
+
+std::size_t ofxPugiXmlParameterMirror::flush(pugi::xml_node root){
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::size_t numWritten = 0;
+    std::uint32_t lanes[4];
+    for(Binding& binding : this->bindings){
+        // Cleared before reading : a concurrent write either makes it in, or marks the slot again
+        if(!binding.value->dirty.exchange(false, std::memory_order_acquire)) continue;
+        pugi::xml_node node = resolveOrAppend(root, binding);
+        if(!node) continue;
+        binding.value->load(lanes, binding.numLanes);
+        binding.write(node, binding.attribute, lanes);
+        ++numWritten;
+    }
+    return numWritten;
+}
+
+std::size_t ofxPugiXmlParameterMirror::flush(ofxPugiXmlSharedSettings& shared){
+    ofxPugiXmlSharedSettings::WriterSession writer = shared.write();
+    const std::size_t numWritten = this->flush(writer.getDocument());
+    // Otherwise the session discards its copy
+    if(numWritten > 0) writer.commit();
+    return numWritten;
+}
+
+bool ofxPugiXmlParameterMirror::flushAsync(ofxPugiXmlSharedSettings& shared, const std::string& xmlFile){
+    if(this->isFlushing()) return false;
+
+    this->flushJob = std::async(std::launch::async, [this, &shared, xmlFile](){
+        this->flush(shared);
+        return xmlFile.empty() || shared.saveFile(xmlFile);
+    });
+    return this->flushJob.valid();
+}
+
+bool ofxPugiXmlParameterMirror::isFlushing() const{
+    return this->flushJob.valid() && this->flushJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+bool ofxPugiXmlParameterMirror::waitForFlush(){
+    if(!this->flushJob.valid()) return true;
+    return this->flushJob.get();
+}
+
+void ofxPugiXmlParameterMirror::markAllDirty(){
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for(Binding& binding : this->bindings) binding.value->dirty.store(true, std::memory_order_relaxed);
+}
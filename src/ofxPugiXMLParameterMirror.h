@@ -0,0 +1,259 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "ofxPugiXMLHelpers.h"
+#include "ofxPugiXMLSettings.h"
+#include "ofxPugiXMLSharedSettings.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Parameter mirror : live values bound to document paths
+// Each bind() registers a path (same syntax as ofxPugiXmlSettings::compilePath()) and returns a typed handle to a slot
+// holding the live value. Handles are read and written from any thread without locks and without touching any XML :
+// values are stored as raw words (double-buffered when wider than one word), a write only sets the slot's dirty flag.
+// The document is only involved in load(), which decodes every bound value, and flush(), which encodes the modified
+// ones in one batch, appending missing nodes. Flushing to an ofxPugiXmlSharedSettings goes through one writer session,
+// flushAsync() does it (and optionally saves) on a worker thread.
+// Scalars are written as the tag's text, glm vectors and ofFloatColor as attributes of the tag (like setNodeValueToAttribute()),
+// a last `@name` segment writes to an attribute instead.
+// Usage :
+//     ofxPugiXmlParameterMirror mirror;
+//     ofxPugiXmlParameterMirror::Handle<float> opacity = mirror.bind("scene/layer[3]/opacity", 1.f);
+//     ofxPugiXmlParameterMirror::Handle<glm::vec3> position = mirror.bind<glm::vec3>("scene/layer[3]/position");
+//     mirror.load(shared);
+//     // any thread, every frame :
+//     opacity = opacityParameter.get();
+//     layer.setPosition(position.get());
+//     // on save :
+//     mirror.flushAsync(shared, "settings.xml");
+// Notes :
+// - Supported types : bool, int, unsigned int, float, double, glm::vec2/vec3/vec4/ivec2 and ofFloatColor.
+// - Binding isn't thread-safe with the handles of the same path, bind everything before sharing the handles.
+// - Readers never wait for writers. Writes are wait-free with one writer per slot : writers of the same slot (wider
+//   than one word) take turns, so a preempted writer delays the other writers of that slot, not the readers.
+// - Handles must not outlive their mirror.
+class ofxPugiXmlParameterMirror {
+public:
+    // Slot storage : up to 4 words in two buffers, so readers never see a torn value and never wait for a writer.
+    // `sequence` is odd while a write is in progress, sequence / 2 counts the completed writes : the last one is in
+    // buffer (sequence / 2) % 2, the one in progress writes the other buffer. A read is only retried if two writes
+    // started while it copied the published buffer.
+    struct Value {
+        Value(){
+            for(auto& buffer : this->buffers){
+                for(std::atomic<std::uint32_t>& lane : buffer) lane.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void store(const std::uint32_t* _lanes, std::size_t _numLanes){
+            // One word is atomic by itself
+            if(_numLanes == 1){
+                this->buffers[0][0].store(_lanes[0], std::memory_order_release);
+                return;
+            }
+            // Writers of the same slot take turns
+            while(this->isWriting.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+            // An RMW : readers seeing the odd sequence still synchronize with the end of the previous write
+            const std::uint32_t sequence = this->sequence.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::atomic<std::uint32_t>* buffer = this->buffers[((sequence >> 1) + 1) & 1];
+            for(std::size_t i = 0; i < _numLanes; ++i) buffer[i].store(_lanes[i], std::memory_order_relaxed);
+            this->sequence.store(sequence + 2, std::memory_order_release);
+            this->isWriting.store(false, std::memory_order_release);
+        }
+
+        void load(std::uint32_t* _lanes, std::size_t _numLanes) const {
+            if(_numLanes == 1){
+                _lanes[0] = this->buffers[0][0].load(std::memory_order_acquire);
+                return;
+            }
+            for(;;){
+                const std::uint32_t sequence = this->sequence.load(std::memory_order_acquire);
+                const std::atomic<std::uint32_t>* buffer = this->buffers[(sequence >> 1) & 1];
+                for(std::size_t i = 0; i < _numLanes; ++i) _lanes[i] = buffer[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // The buffer is only rewritten by the write after the one in progress
+                if(this->sequence.load(std::memory_order_relaxed) - (sequence & ~std::uint32_t(1)) <= 2) return;
+            }
+        }
+
+        std::atomic<std::uint32_t> sequence{0};
+        std::atomic<bool> isWriting{false};
+        std::atomic<std::uint32_t> buffers[2][4];
+        std::atomic<bool> dirty{false};
+    };
+
+    template<typename TYPE>
+    class Handle {
+    public:
+        static_assert(std::is_trivially_copyable<TYPE>::value && sizeof(TYPE) <= sizeof(std::uint32_t) * 4, "ofxPugiXmlParameterMirror only stores small trivially copyable types.");
+        static constexpr std::size_t numLanes = (sizeof(TYPE) + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+
+        Handle(){}
+
+        TYPE get() const {
+            std::uint32_t lanes[numLanes];
+            this->value->load(lanes, numLanes);
+            return decode<TYPE>(lanes);
+        }
+        operator TYPE() const { return this->get(); }
+
+        // Returns false (and doesn't mark the slot) if the value didn't change
+        bool set(const TYPE& _value){
+            std::uint32_t lanes[numLanes];
+            encode(_value, lanes);
+            std::uint32_t current[numLanes];
+            this->value->load(current, numLanes);
+            if(std::memcmp(lanes, current, sizeof(lanes)) == 0) return false;
+            this->value->store(lanes, numLanes);
+            this->value->dirty.store(true, std::memory_order_release);
+            return true;
+        }
+        Handle& operator=(const TYPE& _value){
+            this->set(_value);
+            return *this;
+        }
+
+        // Modified since the last load() or flush()
+        bool isDirty() const { return this->value->dirty.load(std::memory_order_relaxed); }
+        // False if the path couldn't be parsed, or is bound to another type
+        bool isValid() const { return this->value != nullptr; }
+
+    protected:
+        friend class ofxPugiXmlParameterMirror;
+        Value* value = nullptr;
+    };
+
+    ofxPugiXmlParameterMirror();
+    ~ofxPugiXmlParameterMirror();
+    ofxPugiXmlParameterMirror(const ofxPugiXmlParameterMirror&) = delete;
+    ofxPugiXmlParameterMirror& operator=(const ofxPugiXmlParameterMirror&) = delete;
+
+    // Binding the same path again returns the same slot
+    template<typename TYPE>
+    Handle<TYPE> bind(const std::string& path, const TYPE& defaultValue = TYPE()){
+        std::uint32_t lanes[Handle<TYPE>::numLanes];
+        encode(defaultValue, lanes);
+        Handle<TYPE> ret;
+        ret.value = this->addBinding(path, lanes, Handle<TYPE>::numLanes, &writeValue<TYPE>, &readValue<TYPE>);
+        return ret;
+    }
+    std::size_t getNumBindings() const;
+
+    // Decodes the bound values found under root (usually a document), the others keep their value. Clears the dirty flags.
+    // Returns the number of values found.
+    std::size_t load(const pugi::xml_node& root);
+    std::size_t load(const ofxPugiXmlSharedSettings& shared);
+
+    // Encodes the modified values under root, appending missing nodes. Returns the number of values written.
+    std::size_t flush(pugi::xml_node root);
+    // Same, in one writer session, committed if anything was written
+    std::size_t flush(ofxPugiXmlSharedSettings& shared);
+    // Flushes on a worker thread, then saves the shared settings to xmlFile if it isn't empty.
+    // Returns false while a previous flush is running. The shared settings have to outlive the flush.
+    bool flushAsync(ofxPugiXmlSharedSettings& shared, const std::string& xmlFile = "");
+    bool isFlushing() const;
+    // Returns false if the last asynchronous save failed
+    bool waitForFlush();
+
+    // The next flush writes every value (for example to a new document)
+    void markAllDirty();
+
+protected:
+    typedef void (*WriteFunction)(pugi::xml_node& _node, const std::string& _attribute, const std::uint32_t* _lanes);
+    typedef bool (*ReadFunction)(pugi::xml_node& _node, const std::string& _attribute, std::uint32_t* _lanes);
+
+    struct Binding {
+        std::string path;
+        std::vector<ofxPugiXmlSettings::PathSegment> segments;
+        std::string attribute;
+        Value* value = nullptr;
+        std::size_t numLanes = 0;
+        WriteFunction write = nullptr;
+        ReadFunction read = nullptr;
+    };
+
+    Value* addBinding(const std::string& path, const std::uint32_t* lanes, std::size_t numLanes, WriteFunction write, ReadFunction read);
+    static pugi::xml_node resolve(const pugi::xml_node& root, const Binding& binding);
+    static pugi::xml_node resolveOrAppend(pugi::xml_node root, const Binding& binding);
+
+    template<typename TYPE>
+    static void encode(const TYPE& _value, std::uint32_t (&_lanes)[Handle<TYPE>::numLanes]){
+        std::memset(_lanes, 0, sizeof(_lanes));
+        std::memcpy(_lanes, static_cast<const void*>(&_value), sizeof(TYPE));
+    }
+    template<typename TYPE>
+    static TYPE decode(const std::uint32_t* _lanes){
+        TYPE ret;
+        std::memcpy(static_cast<void*>(&ret), _lanes, sizeof(TYPE));
+        return ret;
+    }
+
+    // Scalars go to the tag's text, composite types to its attributes
+    template<typename TYPE>
+    static void writeText(pugi::xml_node& _node, const TYPE& _value){ _node.text().set(_value); }
+    static void writeText(pugi::xml_node& _node, const glm::vec2& _value){ ofxPugiXml::setNodeAttribute(_node, "", _value); }
+    static void writeText(pugi::xml_node& _node, const glm::vec3& _value){ ofxPugiXml::setNodeAttribute(_node, "", _value); }
+    static void writeText(pugi::xml_node& _node, const glm::vec4& _value){ ofxPugiXml::setNodeAttribute(_node, "", _value); }
+    static void writeText(pugi::xml_node& _node, const glm::ivec2& _value){ ofxPugiXml::setNodeAttribute(_node, "", _value); }
+    static void writeText(pugi::xml_node& _node, const ofFloatColor& _value){ ofxPugiXml::setNodeAttribute(_node, "", _value); }
+    template<typename TYPE>
+    static bool readText(pugi::xml_node& _node, TYPE& _value){ return ofxPugiXml::getNodeValue(_node, _value); }
+    static bool readText(pugi::xml_node& _node, glm::vec2& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+    static bool readText(pugi::xml_node& _node, glm::vec3& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+    static bool readText(pugi::xml_node& _node, glm::vec4& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+    static bool readText(pugi::xml_node& _node, glm::ivec2& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+    static bool readText(pugi::xml_node& _node, ofFloatColor& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+
+    template<typename TYPE>
+    static void writeValue(pugi::xml_node& _node, const std::string& _attribute, const std::uint32_t* _lanes){
+        const TYPE value = decode<TYPE>(_lanes);
+        if(_attribute.empty()) writeText(_node, value);
+        else ofxPugiXml::setNodeAttribute(_node, _attribute.c_str(), value);
+    }
+    // Leaves the lanes untouched if nothing was found
+    template<typename TYPE>
+    static bool readValue(pugi::xml_node& _node, const std::string& _attribute, std::uint32_t* _lanes){
+        TYPE value = decode<TYPE>(_lanes);
+        const bool found = _attribute.empty() ? readText(_node, value) : ofxPugiXml::getNodeAttributeValue(_node, _attribute.c_str(), value);
+        if(found) std::memcpy(_lanes, static_cast<const void*>(&value), sizeof(TYPE));
+        return found;
+    }
+
+    mutable std::mutex mutex; // guards the bindings, serializes load() and flush()
+    std::deque<Value> values; // stable addresses for the handles
+    std::vector<Binding> bindings;
+    std::future<bool> flushJob;
+};
@@ -0,0 +1,319 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLRecordSet.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+    // Returns the position right after the next occurrence of _token, nullptr if not found
+    const char* skipPast(const char* p, const char* end, const char* _token, std::size_t _length){
+        while(p < end){
+            p = static_cast<const char*>(std::memchr(p, _token[0], end - p));
+            if(p == nullptr || static_cast<std::size_t>(end - p) < _length) return nullptr;
+            if(std::memcmp(p, _token, _length) == 0) return p + _length;
+            ++p;
+        }
+        return nullptr;
+    }
+
+    // Skips a start tag (p on '<'), honouring quoted attribute values. Returns the position after '>'.
+    const char* skipStartTag(const char* p, const char* end, bool& _selfClosing){
+        for(++p; p < end; ++p){
+            const char c = *p;
+            if(c == '"' || c == '\''){
+                p = static_cast<const char*>(std::memchr(p + 1, c, end - p - 1));
+                if(p == nullptr) return nullptr;
+            }
+            else if(c == '>'){
+                _selfClosing = (p[-1] == '/');
+                return p + 1;
+            }
+        }
+        return nullptr;
+    }
+
+    // Skips `<?...?>`, comments, CDATA and DOCTYPE (p on '<'). Returns the position after it.
+    const char* skipSpecial(const char* p, const char* end){
+        if(p[1] == '?') return skipPast(p + 2, end, "?>", 2);
+        if(end - p >= 4 && std::memcmp(p, "<!--", 4) == 0) return skipPast(p + 4, end, "-->", 3);
+        if(end - p >= 9 && std::memcmp(p, "<![CDATA[", 9) == 0) return skipPast(p + 9, end, "]]>", 3);
+        // DOCTYPE, with an optional [internal subset]
+        int brackets = 0;
+        for(p += 2; p < end; ++p){
+            const char c = *p;
+            if(c == '"' || c == '\''){
+                p = static_cast<const char*>(std::memchr(p + 1, c, end - p - 1));
+                if(p == nullptr) return nullptr;
+            }
+            else if(c == '[') ++brackets;
+            else if(c == ']') --brackets;
+            else if(c == '>' && brackets <= 0) return p + 1;
+        }
+        return nullptr;
+    }
+
+    // True if an xml declaration doesn't declare an encoding other than UTF-8 (or ASCII)
+    bool isUtf8Declaration(const char* begin, const char* end){
+        const char* p = skipPast(begin, end, "encoding", 8);
+        if(p == nullptr) return true;
+        while(p < end && *p != '"' && *p != '\'') ++p;
+        std::string name;
+        for(++p; p < end && *p != '"' && *p != '\''; ++p) name.push_back((char)std::tolower((unsigned char)*p));
+        return name == "utf-8" || name == "utf8" || name == "us-ascii" || name == "ascii";
+    }
+
+    struct RecordScan {
+        const char* rootTagBegin = nullptr;
+        const char* rootTagEnd = nullptr;
+        // Chunk boundaries : [cuts[i], cuts[i+1]) each hold whole records
+        std::vector<const char*> cuts;
+    };
+
+    // Finds the root element and cuts its content after top-level records, about every _chunkSize bytes.
+    // Returns false if the buffer can't be split (not UTF-8, malformed...)
+    bool scanRecords(const char* begin, const char* end, std::size_t _chunkSize, RecordScan& _scan){
+        const char* p = begin;
+        // Only split UTF-8, skip its BOM. UTF-16/32 have zero bytes in their first chars.
+        if(end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+        if(end - p < 4 || std::memchr(p, 0, 4) != nullptr) return false;
+
+        // Prolog
+        for(;;){
+            p = static_cast<const char*>(std::memchr(p, '<', end - p));
+            if(p == nullptr || end - p < 2) return false;
+            if(p[1] != '?' && p[1] != '!') break;
+            const char* next = skipSpecial(p, end);
+            if(next == nullptr) return false;
+            if(end - p >= 5 && std::memcmp(p, "<?xml", 5) == 0 && !isUtf8Declaration(p, next)) return false;
+            p = next;
+        }
+
+        // Root
+        bool selfClosing = false;
+        _scan.rootTagBegin = p;
+        p = skipStartTag(p, end, selfClosing);
+        if(p == nullptr) return false;
+        _scan.rootTagEnd = p;
+        _scan.cuts.clear();
+        _scan.cuts.push_back(p);
+        if(selfClosing) return true;
+
+        const char* chunkBegin = p;
+        const char* lastRecordEnd = p;
+        std::size_t depth = 1;
+        while(depth > 0){
+            p = static_cast<const char*>(std::memchr(p, '<', end - p));
+            if(p == nullptr || end - p < 2) return false;
+
+            const char c = p[1];
+            bool recordEnded = false;
+            if(c == '/'){
+                const char* tagEnd = static_cast<const char*>(std::memchr(p, '>', end - p));
+                if(tagEnd == nullptr) return false;
+                --depth;
+                p = tagEnd + 1;
+                recordEnded = (depth == 1);
+            }
+            else if(c == '!' || c == '?'){
+                p = skipSpecial(p, end);
+                if(p == nullptr) return false;
+            }
+            else {
+                p = skipStartTag(p, end, selfClosing);
+                if(p == nullptr) return false;
+                if(!selfClosing) ++depth;
+                else recordEnded = (depth == 1);
+            }
+
+            if(recordEnded){
+                lastRecordEnd = p;
+                if(static_cast<std::size_t>(p - chunkBegin) >= _chunkSize){
+                    _scan.cuts.push_back(p);
+                    chunkBegin = p;
+                }
+            }
+        }
+        // Last chunk ends after the last record, content between it and `</root>` is dropped
+        if(lastRecordEnd > _scan.cuts.back()) _scan.cuts.push_back(lastRecordEnd);
+        return true;
+    }
+
+    double elapsedMs(const std::chrono::steady_clock::time_point& _start){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+}
+
+//--------------------------------------------------------------
+ofxPugiXmlRecordSet::ofxPugiXmlRecordSet(){
+
+}
+
+ofxPugiXmlRecordSet::~ofxPugiXmlRecordSet(){
+    clear();
+}
+
+void ofxPugiXmlRecordSet::setNumThreads(unsigned int _numThreads){
+    numThreads = _numThreads;
+}
+
+void ofxPugiXmlRecordSet::setMinChunkSize(std::size_t bytes){
+    minChunkSize = std::max<std::size_t>(bytes, 1);
+}
+
+const ofxPugiXmlRecordSet::Stats& ofxPugiXmlRecordSet::getStats() const {
+    return stats;
+}
+
+pugi::xml_node ofxPugiXmlRecordSet::getRoot() const {
+    return rootDoc.document_element();
+}
+
+void ofxPugiXmlRecordSet::clear(){
+    records.clear();
+    chunks.clear();
+    rootDoc.reset();
+    mapping.reset();
+    stats = Stats();
+}
+
+pugi::xml_parse_result ofxPugiXmlRecordSet::load(const std::string& path, unsigned int parseOptions){
+    clear();
+
+    std::shared_ptr<ofxPugiXml::MappedFile> file = std::make_shared<ofxPugiXml::MappedFile>();
+    if(!file->open(path)) return ofxPugiXml::makeParseResult(pugi::status_file_not_found);
+    file->advise(ofxPugiXml::MappedFileAccess::Sequential);
+
+    pugi::xml_parse_result result = loadBufferInPlace(file->getData(), file->getSize(), parseOptions);
+    // After loadBufferInPlace(), which clears the previous mapping
+    mapping = file;
+    return result;
+}
+
+pugi::xml_parse_result ofxPugiXmlRecordSet::parseSingleThreaded(char* data, std::size_t size, unsigned int parseOptions){
+    std::unique_ptr<pugi::xml_document> doc(new pugi::xml_document());
+    pugi::xml_parse_result result = doc->load_buffer_inplace(data, size, parseOptions);
+
+    pugi::xml_node root = doc->document_element();
+    if(root){
+        pugi::xml_node rootCopy = rootDoc.append_child(root.name());
+        for(pugi::xml_attribute attr = root.first_attribute(); attr; attr = attr.next_attribute()) rootCopy.append_copy(attr);
+        for(pugi::xml_node record = root.first_child(); record; record = record.next_sibling()){
+            if(record.type() == pugi::node_element) records.push_back(record);
+        }
+    }
+    chunks.push_back(std::move(doc));
+    stats.numChunks = 1;
+    stats.numThreads = 1;
+    stats.parallel = false;
+    return result;
+}
+
+pugi::xml_parse_result ofxPugiXmlRecordSet::loadBufferInPlace(void* data, std::size_t size, unsigned int parseOptions){
+    clear();
+    if(data == nullptr || size == 0) return ofxPugiXml::makeParseResult(pugi::status_no_document_element);
+
+    char* begin = static_cast<char*>(data);
+    const unsigned int threadCount = (numThreads > 0) ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+    // A few chunks per thread to balance unevenly sized records
+    const std::size_t chunkSize = std::max(minChunkSize, size / (threadCount * 4));
+
+    auto start = std::chrono::steady_clock::now();
+    RecordScan scan;
+    const bool canSplit = scanRecords(begin, begin + size, chunkSize, scan);
+    stats.scanMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    if(!canSplit){
+        pugi::xml_parse_result result = parseSingleThreaded(begin, size, parseOptions);
+        stats.parseMs = elapsedMs(start);
+        return result;
+    }
+
+    // Root element (attributes only), parsed from a self-closed copy of its start tag
+    std::string rootTag(scan.rootTagBegin, scan.rootTagEnd - 1);
+    if(rootTag.back() != '/') rootTag.push_back('/');
+    rootTag.push_back('>');
+    pugi::xml_parse_result result = rootDoc.load_buffer(rootTag.data(), rootTag.size(), parseOptions, pugi::encoding_utf8);
+    if(!result){
+        result.offset += scan.rootTagBegin - begin;
+        return result;
+    }
+
+    const std::size_t numChunks = scan.cuts.size() - 1;
+    std::vector<pugi::xml_parse_result> results(numChunks);
+    std::vector<std::vector<pugi::xml_node> > chunkRecords(numChunks);
+    chunks.resize(numChunks);
+    for(std::unique_ptr<pugi::xml_document>& chunk : chunks) chunk.reset(new pugi::xml_document());
+
+    // Chunks are disjoint ranges of the buffer, in-place parsing only writes within its own range.
+    std::atomic<std::size_t> cursor(0);
+    const unsigned int chunkOptions = parseOptions | pugi::parse_fragment;
+    auto work = [&](){
+        for(std::size_t i = cursor++; i < numChunks; i = cursor++){
+            char* chunkBegin = begin + (scan.cuts[i] - begin);
+            const std::size_t chunkLength = scan.cuts[i + 1] - scan.cuts[i];
+            results[i] = chunks[i]->load_buffer_inplace(chunkBegin, chunkLength, chunkOptions, pugi::encoding_utf8);
+            for(pugi::xml_node record = chunks[i]->first_child(); record; record = record.next_sibling()){
+                if(record.type() == pugi::node_element) chunkRecords[i].push_back(record);
+            }
+        }
+    };
+    const unsigned int usedThreads = (unsigned int)std::max<std::size_t>(1, std::min<std::size_t>(threadCount, numChunks));
+    std::vector<std::thread> workers;
+    workers.reserve(usedThreads - 1);
+    // A thread that can't be started leaves its chunks to the running ones, which still have to be joined
+    try {
+        for(unsigned int i = 1; i < usedThreads; ++i) workers.emplace_back(work);
+    }
+    catch(const std::system_error&){
+    }
+    work();
+    for(std::thread& worker : workers) worker.join();
+
+    // Gather in document order, report the first error with its offset in the whole buffer
+    std::size_t numRecords = 0;
+    for(const std::vector<pugi::xml_node>& nodes : chunkRecords) numRecords += nodes.size();
+    records.reserve(numRecords);
+    for(std::size_t i = 0; i < numChunks; ++i){
+        if(!results[i] && result){
+            result = results[i];
+            result.offset += scan.cuts[i] - begin;
+        }
+        records.insert(records.end(), chunkRecords[i].begin(), chunkRecords[i].end());
+    }
+
+    stats.parseMs = elapsedMs(start);
+    stats.numChunks = numChunks;
+    stats.numThreads = (unsigned int)workers.size() + 1;
+    stats.parallel = true;
+    return result;
+}
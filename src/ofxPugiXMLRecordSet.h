@@ -0,0 +1,101 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLFileUtils.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Parallel parser for huge flat documents : one root holding many independent top-level records.
+// `<log><event .../><event>...</event>...</log>`
+// A fast pre-scan (memchr based) finds the record boundaries, then record ranges are parsed concurrently as
+// fragments, in-place, each into its own document. The records are presented as one sequence of nodes that
+// the helpers (getNodeValue(), getNodeAttributeValue(), ...) consume like regular nodes.
+// Notes:
+// - Records only see their own subtree : parent() of a record is its chunk's document, not the root element.
+// - Only UTF-8 (or ASCII) files are split. Anything else, or a file the pre-scan can't split, is parsed on a single
+//   thread, giving the same records (and pugi's error reporting).
+// - Text and comments directly inside the root (between records) are ignored.
+// Usage :
+//     ofxPugiXmlRecordSet events;
+//     events.load("huge_log.xml");
+//     for(pugi::xml_node event : events){ float t; ofxPugiXml::getNodeAttributeValue(event, "time", t); }
+class ofxPugiXmlRecordSet {
+
+public:
+
+    struct Stats {
+        double scanMs = 0;
+        double parseMs = 0;
+        std::size_t numChunks = 0;
+        unsigned int numThreads = 0;
+        bool parallel = false; // false when falling back to a single-threaded parse
+    };
+
+    ofxPugiXmlRecordSet();
+    ~ofxPugiXmlRecordSet();
+    ofxPugiXmlRecordSet(const ofxPugiXmlRecordSet&) = delete;
+    ofxPugiXmlRecordSet& operator=(const ofxPugiXmlRecordSet&) = delete;
+
+    // 0 (default) uses one thread per core
+    void setNumThreads(unsigned int numThreads);
+    // Files smaller than this aren't split (default 1MB)
+    void setMinChunkSize(std::size_t bytes);
+
+    // Memory-maps the file (path relative to the data folder) and parses it from the mapping.
+    pugi::xml_parse_result load(const std::string& path, unsigned int parseOptions = pugi::parse_default);
+    // Parses a buffer in-place : it's modified and must outlive the records.
+    pugi::xml_parse_result loadBufferInPlace(void* data, std::size_t size, unsigned int parseOptions = pugi::parse_default);
+    void clear();
+
+    // The root element with its attributes (without children)
+    pugi::xml_node getRoot() const;
+
+    const std::vector<pugi::xml_node>& getRecords() const { return records; }
+    std::size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    pugi::xml_node operator[](std::size_t index) const { return records[index]; }
+    std::vector<pugi::xml_node>::const_iterator begin() const { return records.begin(); }
+    std::vector<pugi::xml_node>::const_iterator end() const { return records.end(); }
+
+    const Stats& getStats() const;
+
+protected:
+
+    pugi::xml_parse_result parseSingleThreaded(char* data, std::size_t size, unsigned int parseOptions);
+
+    unsigned int numThreads = 0;
+    std::size_t minChunkSize = 1 << 20;
+
+    // Declared before the documents so it's destroyed after them
+    std::shared_ptr<ofxPugiXml::MappedFile> mapping;
+    pugi::xml_document rootDoc;
+    std::vector<std::unique_ptr<pugi::xml_document> > chunks;
+    std::vector<pugi::xml_node> records;
+    Stats stats;
+};
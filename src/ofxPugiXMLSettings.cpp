@@ -25,6 +25,12 @@
 
 
 #include "ofxPugiXMLSettings.h"
+#include "ofxPugiXMLFileUtils.h"
+#include "ofxPugiXMLDiff.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
 
 ofxPugiXmlSettings::ofxPugiXmlSettings() {
@@ -36,94 +42,422 @@ ofxPugiXmlSettings::ofxPugiXmlSettings(const std::string& xmlFile) {
 }
 
 ofxPugiXmlSettings::~ofxPugiXmlSettings() {
-
+    if(this->asyncJob.valid()){
+        ofRemoveListener(ofEvents().update, this, &ofxPugiXmlSettings::onAsyncUpdate);
+        this->asyncJob.wait();
+    }
 }
 
 pugi::xml_parse_result ofxPugiXmlSettings::loadFile(const std::string& xmlFile){
+    return loadFile(xmlFile, pugi::parse_default, pugi::encoding_auto);
+}
+
+pugi::xml_parse_result ofxPugiXmlSettings::loadFile(const std::string& xmlFile, unsigned int parseOptions, pugi::xml_encoding encoding){
     this->filepath = xmlFile;
 
-    std::string buffer = ofBufferFromFile(xmlFile).getText();
+    const std::string snapshotPath = xmlFile + ".snapshot";
+    ofxPugiXml::Snapshot snapshot;
+    if(this->useSnapshot && snapshot.open(snapshotPath) && snapshot.isValidFor(xmlFile, parseOptions, encoding) && snapshot.toDocument(this->doc)){
+        this->isFileLoaded = ofxPugiXml::makeParseResult(pugi::status_ok);
+    }
+    else {
+        snapshot.close();
+        this->isFileLoaded = ofxPugiXml::loadFileInPlace(this->doc, xmlFile, parseOptions, encoding);
+        if(this->useSnapshot && this->isFileLoaded) ofxPugiXml::Snapshot::save(this->doc, snapshotPath, xmlFile, parseOptions, encoding);
+    }
 
-    this->isFileLoaded = doc.load_string(buffer.c_str());
+    // The document no longer references a previous mapping
+    this->mappedFile.reset();
+    this->invalidateChildIndex();
 
-    if(this->isFileLoaded){
-        this->currentNode = this->doc.root();
-    }
+    // Failed loads leave an empty document : don't keep a cursor into the previous one
+    this->currentNode = this->doc.root();
+    this->loaded(xmlFile, this->isFileLoaded);
 
     return this->isFileLoaded;
 }
 
+pugi::xml_parse_result ofxPugiXmlSettings::loadFileMapped(const std::string& xmlFile, ofxPugiXml::MappedFileAccess access, unsigned int parseOptions, pugi::xml_encoding encoding){
+    this->filepath = xmlFile;
+
+    this->isFileLoaded = ofxPugiXml::loadFileMapped(this->doc, this->mappedFile, xmlFile, access, parseOptions, encoding);
+    this->invalidateChildIndex();
+
+    // Failed loads leave an empty document : don't keep a cursor into the previous one
+    this->currentNode = this->doc.root();
+    this->loaded(xmlFile, this->isFileLoaded);
+
+    return this->isFileLoaded;
+}
+
+void ofxPugiXmlSettings::setUseSnapshot(bool _useSnapshot){
+    this->useSnapshot = _useSnapshot;
+}
+
+bool ofxPugiXmlSettings::getUseSnapshot() const {
+    return this->useSnapshot;
+}
+
+bool ofxPugiXmlSettings::adviseMapping(ofxPugiXml::MappedFileAccess access){
+    if(!this->mappedFile) return false;
+    return this->mappedFile->advise(access);
+}
+
 bool ofxPugiXmlSettings::saveFile(const std::string& xmlFile){
-    return this->doc.save_file(xmlFile.c_str());
+    // A pending saveAsync() would overwrite this with its (older) snapshot
+    if(this->asyncSavePending) this->waitForAsync();
+
+    const bool isSameFile = (xmlFile == this->savedPath) && ofFile::doesFileExist(xmlFile);
+    if(!this->dirty && isSameFile) return true;
+
+    if(this->useJournal && !this->fullWriteNeeded && isSameFile){
+        if(this->writeJournal(xmlFile)){
+            this->markClean(xmlFile);
+            return true;
+        }
+    }
+
+    if(!ofxPugiXml::saveFileAtomic(this->doc, xmlFile)) return false;
+    // The file is up to date, a journal would be stale
+    std::remove(ofToDataPath(xmlFile + ".journal").c_str());
+    this->markClean(xmlFile);
+    return true;
 }
 
 bool ofxPugiXmlSettings::saveFile(){
-    return this->doc.save_file(this->filepath.c_str());
+    return this->saveFile(this->filepath);
 }
 
-pugi::xml_parse_result ofxPugiXmlSettings::load(const std::string & path) {
-    return loadFile(path);
+bool ofxPugiXmlSettings::compact(){
+    this->fullWriteNeeded = true;
+    this->dirty = true;
+    return this->saveFile(this->savedPath.empty() ? this->filepath : this->savedPath);
 }
 
-bool ofxPugiXmlSettings::save(const std::string & path) {
-    return saveFile(path);
+// Dirty tracking
+bool ofxPugiXmlSettings::isDirty() const {
+    return this->dirty;
 }
 
+void ofxPugiXmlSettings::markDirty(){
+    this->dirty = true;
+    this->fullWriteNeeded = true;
+    this->modificationCount++;
+    this->generation++;
+    // Whatever changed, memoized hashes can't be trusted anymore
+    this->hashCache.clear();
+}
 
-void ofxPugiXmlSettings::removeTag(const std::string& tag, int which){
-    int counter = 0;
+void ofxPugiXmlSettings::setUseJournal(bool _useJournal){
+    // Changes made so far weren't tracked
+    if(_useJournal && !this->useJournal && this->dirty) this->fullWriteNeeded = true;
+    this->useJournal = _useJournal;
+}
 
-    if(which < 0) which = 0;
+bool ofxPugiXmlSettings::getUseJournal() const {
+    return this->useJournal;
+}
 
-    for (pugi::xml_node currentTag : this->currentNode.children(tag.c_str())){
-        if(which == counter){
-            this->currentNode.remove_child(currentTag);
-            break;
+void ofxPugiXmlSettings::modified(const pugi::xml_node& node){
+    this->dirty = true;
+    this->modificationCount++;
+    this->generation++;
+    this->hashCache.invalidate(node);
+
+    if(!this->useJournal){
+        this->fullWriteNeeded = true;
+        return;
+    }
+    if(this->fullWriteNeeded) return;
+
+    // Already part of a modified subtree ?
+    for(pugi::xml_node parent = node; parent; parent = parent.parent()){
+        if(std::find(this->dirtyNodes.begin(), this->dirtyNodes.end(), parent) != this->dirtyNodes.end()) return;
+    }
+    // Drop the modified subtrees it contains (they might be removed next)
+    this->dirtyNodes.erase(std::remove_if(this->dirtyNodes.begin(), this->dirtyNodes.end(), [&node](const pugi::xml_node& dirtyNode){
+        for(pugi::xml_node parent = dirtyNode.parent(); parent; parent = parent.parent()){
+            if(parent == node) return true;
         }
-        counter++;
+        return false;
+    }), this->dirtyNodes.end());
+    this->dirtyNodes.push_back(node);
+
+    // Lots of scattered changes : rather rewrite the file
+    if(this->dirtyNodes.size() > 256 || node.type() == pugi::node_document){
+        this->fullWriteNeeded = true;
+        this->dirtyNodes.clear();
     }
 }
 
-int ofxPugiXmlSettings::getValue(const std::string& tag, int defaultValue, int which) const {
-    int counter = 0;
+void ofxPugiXmlSettings::loaded(const std::string& xmlFile, bool success){
+    // Not the document a pending saveAsync() snapshotted anymore
+    this->modificationCount++;
+    this->generation++;
+    this->hashCache.clear();
+    if(success) this->replayJournal(xmlFile);
+    this->markClean(success ? xmlFile : std::string());
+}
 
-    if(which < 0) which = 0;
+void ofxPugiXmlSettings::markClean(const std::string& xmlFile){
+    this->dirty = false;
+    this->fullWriteNeeded = false;
+    this->dirtyNodes.clear();
+    this->savedPath = xmlFile;
+}
 
-    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
-        if(which == counter){
-            return currentTag.text().as_int();
+bool ofxPugiXmlSettings::writeJournal(const std::string& xmlFile){
+    std::uint64_t baseSize = 0;
+    std::int64_t baseTime = 0;
+    if(!ofxPugiXml::getFileInfo(xmlFile, baseSize, baseTime)) return false;
+
+    const std::string journalPath = ofToDataPath(xmlFile + ".journal");
+    // A journal starts with the file it applies to
+    const std::string header = "<journal size=\"" + std::to_string(baseSize) + "\" time=\"" + std::to_string(baseTime) + "\" />\n";
+    bool hasHeader = false;
+    if(std::FILE* existing = std::fopen(journalPath.c_str(), "rb")){
+        std::string existingHeader(header.size(), '\0');
+        const std::size_t length = std::fread(&existingHeader[0], 1, existingHeader.size(), existing);
+        std::fclose(existing);
+        if(length > 0){
+            // Written for another version of the file (edited behind our back) : its entries don't apply anymore,
+            // and ours are relative to what it had. Drop it, the caller rewrites the whole file.
+            if(length != header.size() || existingHeader != header){
+                std::remove(journalPath.c_str());
+                return false;
+            }
+            hasHeader = true;
         }
-        counter++;
     }
 
-    return 0;
+    ofxPugiXml::FileWriter writer;
+    writer.file = std::fopen(journalPath.c_str(), hasHeader ? "ab" : "wb");
+    if(writer.file == nullptr) return false;
+    if(!hasHeader) writer.write(header.data(), header.size());
+    for(const pugi::xml_node& node : this->dirtyNodes){
+        const std::string entry = "<replace path=\"" + ofxPugiXml::getNodePath(node) + "\">";
+        writer.write(entry.data(), entry.size());
+        node.print(writer, "", pugi::format_raw);
+        writer.write("</replace>\n", 11);
+    }
+    const bool ret = !writer.failed && ofxPugiXml::syncFile(writer.file);
+    const long journalSize = std::ftell(writer.file);
+    std::fclose(writer.file);
+    if(!ret) return false;
+
+    // Merge big journals
+    if(journalSize > 0 && static_cast<std::uint64_t>(journalSize) > baseSize / 2){
+        if(ofxPugiXml::saveFileAtomic(this->doc, xmlFile)) std::remove(journalPath.c_str());
+    }
+    return true;
 }
 
-double ofxPugiXmlSettings::getValue(const std::string&tag, double defaultValue, int which) const{
-    int counter = 0;
+bool ofxPugiXmlSettings::replayJournal(const std::string& xmlFile){
+    pugi::xml_document journal;
+    pugi::xml_parse_result result = journal.load_file(ofToDataPath(xmlFile + ".journal").c_str(), pugi::parse_default | pugi::parse_fragment);
+    pugi::xml_node header = journal.child("journal");
+    if(!header) return false;
+
+    // Only apply a journal written for this very file
+    std::uint64_t baseSize = 0;
+    std::int64_t baseTime = 0;
+    if(!ofxPugiXml::getFileInfo(xmlFile, baseSize, baseTime)) return false;
+    if(header.attribute("size").as_ullong() != baseSize || header.attribute("time").as_llong() != baseTime){
+        // The file was written without it (edited by hand, saved by another app...) : the file wins.
+        // Removed now, so the next saveFile() doesn't append to it.
+        std::remove(ofToDataPath(xmlFile + ".journal").c_str());
+        return false;
+    }
 
-    if(which < 0) which = 0;
+    for(pugi::xml_node entry = header.next_sibling("replace"); entry; entry = entry.next_sibling("replace")){
+        // An interrupted write leaves an incomplete last entry
+        if(!result && !entry.next_sibling("replace")) break;
 
-    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
-        if(which == counter){
-            return currentTag.text().as_double();
+        pugi::xml_node target = ofxPugiXml::findNodePath(this->doc, entry.attribute("path").value());
+        pugi::xml_node replacement = entry.first_child();
+        if(!target || !replacement || !target.parent()) continue;
+        target.parent().insert_copy_after(replacement, target);
+        target.parent().remove_child(target);
+    }
+    this->invalidateChildIndex();
+    this->hashCache.clear();
+    this->currentNode = this->doc.root();
+    return true;
+}
+
+bool ofxPugiXmlSettings::loadAsync(const std::string& xmlFile, unsigned int parseOptions, pugi::xml_encoding encoding){
+    if(this->isAsyncBusy()) return false;
+
+    return this->startAsync(std::async(std::launch::async, [xmlFile, parseOptions, encoding](){
+        const auto start = std::chrono::steady_clock::now();
+        AsyncJob job;
+        job.result.path = xmlFile;
+        job.result.isLoad = true;
+        job.loadedDoc.reset(new pugi::xml_document());
+        job.result.parseResult = ofxPugiXml::loadFileInPlace(*job.loadedDoc, xmlFile, parseOptions, encoding);
+        job.result.success = job.result.parseResult;
+        job.result.offThreadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return job;
+    }));
+}
+
+bool ofxPugiXmlSettings::saveAsync(const std::string& xmlFile){
+    if(this->isAsyncBusy()) return false;
+
+    // Snapshot on this thread, the worker never touches our document
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<pugi::xml_document> snapshot = std::make_shared<pugi::xml_document>();
+    snapshot->reset(this->doc);
+    const double onThreadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    this->asyncSaveModificationCount = this->modificationCount;
+
+    return this->asyncSavePending = this->startAsync(std::async(std::launch::async, [xmlFile, snapshot, onThreadMs](){
+        const auto start = std::chrono::steady_clock::now();
+        AsyncJob job;
+        job.result.path = xmlFile;
+        job.result.isLoad = false;
+        job.result.success = ofxPugiXml::saveFileAtomic(*snapshot, xmlFile);
+        job.result.offThreadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        job.result.onThreadMs = onThreadMs;
+        return job;
+    }));
+}
+
+bool ofxPugiXmlSettings::saveAsync(){
+    return this->saveAsync(this->filepath);
+}
+
+bool ofxPugiXmlSettings::isAsyncBusy() const {
+    return this->asyncJob.valid();
+}
+
+void ofxPugiXmlSettings::waitForAsync(){
+    if(!this->asyncJob.valid()) return;
+    this->asyncJob.wait();
+    this->completeAsync();
+}
+
+const ofxPugiXmlSettings::AsyncStats& ofxPugiXmlSettings::getAsyncStats() const {
+    return this->asyncStats;
+}
+
+bool ofxPugiXmlSettings::startAsync(std::future<AsyncJob>&& job){
+    this->asyncJob = std::move(job);
+    if(!this->asyncJob.valid()) return false;
+    ofAddListener(ofEvents().update, this, &ofxPugiXmlSettings::onAsyncUpdate);
+    return true;
+}
+
+void ofxPugiXmlSettings::onAsyncUpdate(ofEventArgs&){
+    if(this->asyncJob.valid() && this->asyncJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready){
+        this->completeAsync();
+    }
+}
+
+void ofxPugiXmlSettings::completeAsync(){
+    ofRemoveListener(ofEvents().update, this, &ofxPugiXmlSettings::onAsyncUpdate);
+    AsyncJob job = this->asyncJob.get();
+
+    if(job.result.isLoad){
+        if(job.result.success){
+            const auto start = std::chrono::steady_clock::now();
+            this->filepath = job.result.path;
+            this->isFileLoaded = job.result.parseResult;
+#if PUGIXML_VERSION >= 1110 && defined(PUGIXML_HAS_MOVE)
+            this->doc = std::move(*job.loadedDoc);
+#else
+            // No move semantics before pugixml 1.11, copy it.
+            this->doc.reset(*job.loadedDoc);
+#endif
+            this->mappedFile.reset();
+            this->invalidateChildIndex();
+            this->currentNode = this->doc.root();
+            this->loaded(job.result.path, true);
+            job.result.onThreadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
         }
-        counter++;
+        job.loadedDoc.reset();
+        this->asyncStats.numLoads++;
+    }
+    else {
+        this->asyncSavePending = false;
+        this->asyncStats.numSaves++;
+        if(job.result.success){
+            if(this->modificationCount == this->asyncSaveModificationCount){
+                // The file is up to date, a journal would be stale
+                std::remove(ofToDataPath(job.result.path + ".journal").c_str());
+                this->markClean(job.result.path);
+            }
+            else {
+                // Modified since the snapshot : the file holds an older state, keep the journal and rewrite it all next time
+                this->dirty = true;
+                if(this->savedPath == job.result.path) this->fullWriteNeeded = true;
+            }
+        }
+    }
+    this->asyncStats.offThreadMs += job.result.offThreadMs;
+    this->asyncStats.onThreadMs += job.result.onThreadMs;
+
+    ofNotifyEvent(job.result.isLoad ? this->loadCompleted : this->saveCompleted, job.result, this);
+}
+
+#ifndef PUGIXML_NO_XPATH
+pugi::xpath_node_set ofxPugiXmlSettings::selectNodes(const std::string& expression, const ofxPugiXml::XPathVariables* variables){
+    return this->xpathCache.selectNodes(this->getXPathContext(), expression.c_str(), variables);
+}
+
+pugi::xpath_node ofxPugiXmlSettings::selectNode(const std::string& expression, const ofxPugiXml::XPathVariables* variables){
+    return this->xpathCache.selectNode(this->getXPathContext(), expression.c_str(), variables);
+}
+
+ofxPugiXml::XPathCache& ofxPugiXmlSettings::getXPathCache(){
+    return this->xpathCache;
+}
+
+pugi::xml_node ofxPugiXmlSettings::getXPathContext() const {
+    return this->currentNode ? this->currentNode : this->doc.root();
+}
+#endif
+
+pugi::xml_parse_result ofxPugiXmlSettings::load(const std::string & path) {
+    return loadFile(path);
+}
+
+bool ofxPugiXmlSettings::save(const std::string & path) {
+    return saveFile(path);
+}
+
+
+void ofxPugiXmlSettings::removeTag(const std::string& tag, int which){
+    pugi::xml_node currentTag = this->findChild(tag, which);
+    if(currentTag){
+        this->modified(this->currentNode);
+        this->hashCache.invalidateSubtree(currentTag);
+        this->currentNode.remove_child(currentTag);
+        // Indexes of the removed subtree are dangling now
+        this->invalidateChildIndex();
+    }
+}
+
+int ofxPugiXmlSettings::getValue(const std::string& tag, int defaultValue, int which) const {
+    if(pugi::xml_node currentTag = this->findChild(tag, which)){
+        return currentTag.text().as_int();
     }
 
     return 0;
 }
 
-std::string ofxPugiXmlSettings::getValue(const std::string& tag, const string& defaultValue, int which) const{
-    int counter = 0;
+double ofxPugiXmlSettings::getValue(const std::string&tag, double defaultValue, int which) const{
+    if(pugi::xml_node currentTag = this->findChild(tag, which)){
+        return currentTag.text().as_double();
+    }
 
-    if(which < 0) which = 0;
+    return 0;
+}
 
-    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
-        if(which == counter){
-            return currentTag.text().as_string();
-        }
-        counter++;
+std::string ofxPugiXmlSettings::getValue(const std::string& tag, const string& defaultValue, int which) const{
+    if(pugi::xml_node currentTag = this->findChild(tag, which)){
+        return currentTag.text().as_string();
     }
 
     return "";
@@ -133,27 +467,36 @@ void ofxPugiXmlSettings::setValue(const std::string& tag, int value){
     pugi::xml_node checkNode = this->currentNode.child(tag.c_str());
     if(!checkNode){
         pugi::xml_node newNode = this->currentNode.append_child(tag.c_str());
+        this->invalidateChildIndex(this->currentNode);
         newNode.set_value(ofToString(value).c_str());
+        this->modified(this->currentNode);
     }else{
-        this->currentNode.child(tag.c_str()).set_value(ofToString(value).c_str());
+        checkNode.set_value(ofToString(value).c_str());
+        this->modified(checkNode);
     }
 }
 void ofxPugiXmlSettings::setValue(const std::string& tag, double value){
     pugi::xml_node checkNode = this->currentNode.child(tag.c_str());
     if(!checkNode){
         pugi::xml_node newNode = this->currentNode.append_child(tag.c_str());
+        this->invalidateChildIndex(this->currentNode);
         newNode.set_value(ofToString(value).c_str());
+        this->modified(this->currentNode);
     }else{
-        this->currentNode.child(tag.c_str()).set_value(ofToString(value).c_str());
+        checkNode.set_value(ofToString(value).c_str());
+        this->modified(checkNode);
     }
 }
 void ofxPugiXmlSettings::setValue(const std::string& tag, const std::string& value){
     pugi::xml_node checkNode = this->currentNode.child(tag.c_str());
     if(!checkNode){
         pugi::xml_node newNode = this->currentNode.append_child(tag.c_str());
+        this->invalidateChildIndex(this->currentNode);
         newNode.set_value(value.c_str());
+        this->modified(this->currentNode);
     }else{
-        this->currentNode.child(tag.c_str()).set_value(value.c_str());
+        checkNode.set_value(value.c_str());
+        this->modified(checkNode);
     }
 }
 
@@ -168,21 +511,12 @@ void ofxPugiXmlSettings::setValue(const std::string& tag, const std::string& val
 //at the top most level.
 
 bool ofxPugiXmlSettings::pushTag(const std::string& tag, int which){
-    bool found = false;
-
-    int counter = 0;
-    if(which < 0) which = 0;
-
-    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
-        if(counter == which){
-            this->currentNode = currentTag;
-            found = true;
-            break;
-        }
-        counter++;
+    if(pugi::xml_node currentTag = this->findChild(tag, which)){
+        this->currentNode = currentTag;
+        return true;
     }
 
-    return found;
+    return false;
 }
 void ofxPugiXmlSettings::popTag(){
     pugi::xml_node parentTag = this->currentNode.parent();
@@ -190,6 +524,10 @@ void ofxPugiXmlSettings::popTag(){
 }
 
 int ofxPugiXmlSettings::getNumTags(const std::string& tag) const{
+    if(this->useChildIndex){
+        return static_cast<int>(this->getIndexedChildren(tag).size());
+    }
+
     int counter = 0;
     for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
         counter++;
@@ -200,39 +538,41 @@ int ofxPugiXmlSettings::getNumTags(const std::string& tag) const{
 //adds an empty tag at the current level
 void ofxPugiXmlSettings::addTag(const std::string& tag){
     this->currentNode.append_child(tag.c_str());
+    this->invalidateChildIndex(this->currentNode);
+    this->modified(this->currentNode);
 }
 
 // Attribute-related methods
 void ofxPugiXmlSettings::addAttribute(const std::string& tag, const std::string& attribute, int value){
-    this->currentNode.child(tag.c_str()).append_attribute(attribute.c_str()) = ofToString(value).c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    tagNode.append_attribute(attribute.c_str()) = ofToString(value).c_str();
+    if(tagNode) this->modified(tagNode);
 }
 
 void ofxPugiXmlSettings::addAttribute(const std::string& tag, const std::string& attribute, double value){
-    this->currentNode.child(tag.c_str()).append_attribute(attribute.c_str()) = ofToString(value).c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    tagNode.append_attribute(attribute.c_str()) = ofToString(value).c_str();
+    if(tagNode) this->modified(tagNode);
 }
 
 void ofxPugiXmlSettings::addAttribute(const std::string& tag, const std::string& attribute, const std::string& value){
-    this->currentNode.child(tag.c_str()).append_attribute(attribute.c_str()) = value.c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    tagNode.append_attribute(attribute.c_str()) = value.c_str();
+    if(tagNode) this->modified(tagNode);
 }
 
 void ofxPugiXmlSettings::removeAttribute(const std::string& tag, const std::string& attribute){
-    this->currentNode.child(tag.c_str()).remove_attribute(attribute.c_str());
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    if(tagNode.remove_attribute(attribute.c_str())) this->modified(tagNode);
 }
 
 int ofxPugiXmlSettings::getNumAttributes(const std::string& tag, int which) const{
-    int counter = 0;
     int numAttributes = 0;
 
-    if(which < 0) which = 0;
-
-    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
-        if(which == counter){
-            for(pugi::xml_attribute currentAttr: currentTag.attributes()){
-                numAttributes++;
-            }
-            break;
+    if(pugi::xml_node currentTag = this->findChild(tag, which)){
+        for(pugi::xml_attribute currentAttr: currentTag.attributes()){
+            numAttributes++;
         }
-        counter++;
     }
 
     return numAttributes;
@@ -251,13 +591,135 @@ std::string ofxPugiXmlSettings::getAttribute(const std::string& tag, const std::
 }
 
 void ofxPugiXmlSettings::setAttribute(const std::string& tag, const std::string& attribute, int value){
-    this->currentNode.child(tag.c_str()).attribute(attribute.c_str()) = ofToString(value).c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    if(pugi::xml_attribute attr = tagNode.attribute(attribute.c_str())){
+        attr = ofToString(value).c_str();
+        this->modified(tagNode);
+    }
 }
 
 void ofxPugiXmlSettings::setAttribute(const std::string& tag, const std::string& attribute, double value){
-    this->currentNode.child(tag.c_str()).attribute(attribute.c_str()) = ofToString(value).c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    if(pugi::xml_attribute attr = tagNode.attribute(attribute.c_str())){
+        attr = ofToString(value).c_str();
+        this->modified(tagNode);
+    }
 }
 
 void ofxPugiXmlSettings::setAttribute(const std::string& tag, const std::string& attribute, const std::string& value){
-    this->currentNode.child(tag.c_str()).attribute(attribute.c_str()) = value.c_str();
+    pugi::xml_node tagNode = this->currentNode.child(tag.c_str());
+    if(pugi::xml_attribute attr = tagNode.attribute(attribute.c_str())){
+        attr = value.c_str();
+        this->modified(tagNode);
+    }
+}
+
+// Change detection
+std::uint64_t ofxPugiXmlSettings::getHash(const std::string& tag, int which) const{
+    return this->hashCache.getHash(this->findChild(tag, which));
+}
+
+std::uint64_t ofxPugiXmlSettings::getHash() const{
+    return this->hashCache.getHash(this->currentNode ? this->currentNode : this->doc.root());
+}
+
+// Compiled paths
+bool ofxPugiXmlSettings::parsePath(const std::string& path, std::vector<PathSegment>& segments, std::string& attribute){
+    segments.clear();
+    attribute.clear();
+    std::size_t start = (!path.empty() && path[0] == '/') ? 1 : 0;
+    while(start < path.size()){
+        std::size_t end = path.find('/', start);
+        if(end == std::string::npos) end = path.size();
+        if(end == start) return false;
+
+        if(path[start] == '@'){
+            // Attributes can only end a path
+            if(end != path.size() || end == start + 1) return false;
+            attribute = path.substr(start + 1);
+            return !segments.empty();
+        }
+
+        PathSegment segment;
+        std::size_t bracket = path.find('[', start);
+        if(bracket < end){
+            if(path[end - 1] != ']' || bracket == start) return false;
+            char* numberEnd = nullptr;
+            long which = std::strtol(path.c_str() + bracket + 1, &numberEnd, 10);
+            if(numberEnd != path.c_str() + end - 1 || which < 0) return false;
+            segment.name = path.substr(start, bracket - start);
+            segment.which = static_cast<int>(which);
+        }
+        else {
+            segment.name = path.substr(start, end - start);
+        }
+        segments.push_back(std::move(segment));
+        start = end + 1;
+    }
+    return !segments.empty();
+}
+
+pugi::xml_node ofxPugiXmlSettings::resolvePath(const std::vector<PathSegment>& segments) const{
+    pugi::xml_node node = this->doc.root();
+    for(const PathSegment& segment : segments){
+        node = node.child(segment.name.c_str());
+        for(int i = 0; i < segment.which && node; ++i) node = node.next_sibling(segment.name.c_str());
+        if(!node) break;
+    }
+    return node;
+}
+
+// Indexed child lookup
+void ofxPugiXmlSettings::setUseChildIndex(bool useIndex){
+    this->useChildIndex = useIndex;
+    if(!useIndex) this->invalidateChildIndex();
+}
+
+bool ofxPugiXmlSettings::getUseChildIndex() const{
+    return this->useChildIndex;
+}
+
+void ofxPugiXmlSettings::invalidateChildIndex(){
+    this->childIndexes.clear();
+}
+
+void ofxPugiXmlSettings::invalidateChildIndex(const pugi::xml_node& node){
+    this->childIndexes.erase(node.internal_object());
+}
+
+pugi::xml_node ofxPugiXmlSettings::findChild(const std::string& tag, int which) const{
+    if(which < 0) which = 0;
+
+    if(this->useChildIndex){
+        const std::vector<pugi::xml_node>& children = this->getIndexedChildren(tag);
+        if(which < static_cast<int>(children.size())) return children[which];
+        return pugi::xml_node();
+    }
+
+    int counter = 0;
+    for (pugi::xml_node currentTag: this->currentNode.children(tag.c_str())){
+        if(which == counter){
+            return currentTag;
+        }
+        counter++;
+    }
+    return pugi::xml_node();
+}
+
+const std::vector<pugi::xml_node>& ofxPugiXmlSettings::getIndexedChildren(const std::string& tag) const{
+    auto found = this->childIndexes.find(this->currentNode.internal_object());
+    if(found == this->childIndexes.end()){
+        // Index all children in a single pass
+        found = this->childIndexes.emplace(this->currentNode.internal_object(), ChildIndex()).first;
+        for (pugi::xml_node child: this->currentNode.children()){
+            if(child.type() == pugi::node_element){
+                found->second[child.name()].push_back(child);
+            }
+        }
+    }
+
+    static const std::vector<pugi::xml_node> noChildren;
+    auto children = found->second.find(tag);
+    if(children == found->second.end()) return noChildren;
+    return children->second;
 }
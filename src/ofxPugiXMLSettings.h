@@ -29,6 +29,12 @@
 #include "pugixml.hpp"
 
 #include "ofMain.h"
+#include "ofxPugiXMLFileUtils.h"
+#include "ofxPugiXMLXPath.h"
+#include "ofxPugiXMLHash.h"
+#include "ofxPugiXMLSnapshot.h"
+#include <unordered_map>
+#include <future>
 
 
 // A compatibility layer for ofxXmlSettings (which uses libTinyXML)
@@ -47,10 +53,167 @@ public:
 
     pugi::xml_parse_result loadFile(const std::string& xmlFile);
 
+    // Same as above, with custom parse flags and encoding.
+    // The file is read once into a buffer owned by the document and parsed in-place (no intermediate copies).
+    pugi::xml_parse_result loadFile(const std::string& xmlFile, unsigned int parseOptions, pugi::xml_encoding encoding = pugi::encoding_auto);
+
+    // Binary snapshots (disabled by default)
+    // loadFile() then keeps a snapshot of the parsed document next to the file (`<file>.snapshot`, see ofxPugiXml::Snapshot).
+    // Next loads with the same parse options and encoding rebuild the document from it, as long as the file didn't change.
+    // The first load (and the first after each change) parses as usual and writes the snapshot.
+    void setUseSnapshot(bool useSnapshot);
+    bool getUseSnapshot() const;
+
+    // Read-only friendly mode : the file is memory-mapped and parsed straight out of the mapping, without heap copy.
+    // The mapping lives as long as the loaded document. Use `access` to hint the OS about your lookup pattern.
+    // Parsing dirties the mapped pages : processes loading the same file don't share its memory (see ofxPugiXml::loadFileMapped).
+    pugi::xml_parse_result loadFileMapped(const std::string& xmlFile, ofxPugiXml::MappedFileAccess access = ofxPugiXml::MappedFileAccess::Normal, unsigned int parseOptions = pugi::parse_default, pugi::xml_encoding encoding = pugi::encoding_auto);
+
+    // Changes the access hint of the current mapping (if loaded with loadFileMapped)
+    bool adviseMapping(ofxPugiXml::MappedFileAccess access);
+
+    // Saves atomically (see ofxPugiXml::saveFileAtomic). Paths are relative to the data folder, like loadFile().
+    // Skips writing when the document wasn't modified since it was loaded from / saved to that file.
+    // Waits for a pending saveAsync() first, so its snapshot can't replace what this writes.
     bool saveFile(const std::string& xmlFile);
 
     bool saveFile();
 
+    // Dirty tracking
+    // The mutators of this class mark the document as modified. If you modify it directly, call markDirty().
+    bool isDirty() const;
+    void markDirty();
+
+    // Journaled saves (disabled by default)
+    // Instead of rewriting the whole file, saveFile() appends the modified subtrees to `<file>.journal`.
+    // loadFile() replays the journal if it matches the file (size and modification time), and deletes it otherwise : a
+    // file edited elsewhere wins over the journal.
+    // compact() merges the journal into the file, which also happens when the journal outgrows half of the file.
+    // Note: the journal addresses nodes by position, don't combine it with parse options keeping whitespace nodes.
+    void setUseJournal(bool useJournal);
+    bool getUseJournal() const;
+    bool compact();
+
+    // Change detection
+    // Content hash of the `which`-th tag named `tag` (or of the current tag), see ofxPugiXml::hashNode().
+    // Hashes are memoized and invalidated by the mutators : unchanged subtrees cost a lookup. Returns 0 if there's no such tag.
+    // Editing nodes directly (obtained from selectNodes(), a Path's getNode()...) leaves stale hashes : call markDirty() after.
+    // Usage :
+    //     std::uint64_t hash = settings.getHash("shader");
+    //     if(hash != shaderHash){ shaderHash = hash; rebuildShader(); }
+    std::uint64_t getHash(const std::string& tag, int which = 0) const;
+    std::uint64_t getHash() const;
+
+    // Compiled paths
+    // compilePath() parses a path like "scene/layer[3]/opacity" once, from the document root. `[n]` selects the n-th tag
+    // of that name (0-based, like `which`), a last `@name` segment reads an attribute instead of the tag's value.
+    // The handle caches the resolved node and its decoded value : reading it is a pointer dereference, until the
+    // document is modified (by the mutators, a load or markDirty()), then the next read resolves and decodes again.
+    // There's a single generation per document : any change, even to an unrelated tag, makes every handle resolve and
+    // decode again on its next read. Handles pay off for values read often and rarely written.
+    // Handles must not outlive their ofxPugiXmlSettings.
+    // Usage :
+    //     ofxPugiXmlSettings::Path<float> opacity = settings.compilePath("scene/layer[3]/opacity", 1.f);
+    //     // every frame :
+    //     layer.setOpacity(opacity.get());
+    struct PathSegment {
+        std::string name;
+        int which = 0;
+    };
+    template<typename TYPE>
+    class Path {
+    public:
+        Path(){}
+
+        // Returns the value, or the default if the path doesn't resolve
+        const TYPE& get(){
+            if(this->generation != this->settings->generation) this->update();
+            return this->value;
+        }
+        operator const TYPE&(){ return this->get(); }
+
+        bool exists(){
+            if(this->generation != this->settings->generation) this->update();
+            return this->found;
+        }
+        pugi::xml_node getNode(){
+            if(this->generation != this->settings->generation) this->update();
+            return this->node;
+        }
+        // False if the path couldn't be parsed
+        bool isValid() const { return this->settings != nullptr; }
+
+    protected:
+        friend class ofxPugiXmlSettings;
+
+        void update(){
+            this->generation = this->settings->generation;
+            this->node = this->settings->resolvePath(this->segments);
+            this->value = this->defaultValue;
+            if(!this->node) this->found = false;
+            else if(this->attribute.empty()) this->found = readValue(this->node, this->value);
+            else this->found = ofxPugiXml::getNodeAttributeValue(this->node, this->attribute.c_str(), this->value, &this->defaultValue);
+        }
+
+        // Composite types are stored as attributes of their node (see setNodeValueToAttribute)
+        template<typename VALUE>
+        static bool readValue(pugi::xml_node& _node, VALUE& _value){ return ofxPugiXml::getNodeValue(_node, _value); }
+        static bool readValue(pugi::xml_node& _node, glm::vec2& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+        static bool readValue(pugi::xml_node& _node, glm::vec3& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+        static bool readValue(pugi::xml_node& _node, glm::vec4& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+        static bool readValue(pugi::xml_node& _node, glm::ivec2& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+        static bool readValue(pugi::xml_node& _node, ofFloatColor& _value){ return ofxPugiXml::getNodeAttributeValue(_node, "", _value); }
+
+        const ofxPugiXmlSettings* settings = nullptr;
+        std::vector<PathSegment> segments;
+        std::string attribute;
+        TYPE defaultValue = TYPE();
+        TYPE value = TYPE();
+        pugi::xml_node node;
+        bool found = false;
+        std::uint64_t generation = 0; // settings->generation starts at 1 : the first read resolves
+    };
+
+    template<typename TYPE>
+    Path<TYPE> compilePath(const std::string& path, const TYPE& defaultValue = TYPE()) const {
+        Path<TYPE> ret;
+        ret.defaultValue = defaultValue;
+        ret.value = defaultValue;
+        if(parsePath(path, ret.segments, ret.attribute)) ret.settings = this;
+        return ret;
+    }
+
+    // Asynchronous load/save
+    // File I/O and parsing/serializing run on a worker thread, so big documents don't cause frame drops.
+    // Completion is notified on the main thread (during ofEvents().update) through loadCompleted / saveCompleted,
+    // or poll isAsyncBusy() from your update(). Only one operation runs at a time : these return false while busy.
+    struct AsyncResult {
+        std::string path;
+        bool isLoad = false;
+        bool success = false;
+        pugi::xml_parse_result parseResult; // loads only
+        double offThreadMs = 0; // I/O + parse/serialize on the worker
+        double onThreadMs = 0;  // snapshot (save) or document swap (load) on the calling thread
+    };
+    struct AsyncStats {
+        unsigned int numLoads = 0;
+        unsigned int numSaves = 0;
+        double offThreadMs = 0;
+        double onThreadMs = 0;
+    };
+    ofEvent<AsyncResult> loadCompleted;
+    ofEvent<AsyncResult> saveCompleted;
+
+    // The current document stays in use until the new one is parsed. On failure it's kept as is.
+    bool loadAsync(const std::string& xmlFile, unsigned int parseOptions = pugi::parse_default, pugi::xml_encoding encoding = pugi::encoding_auto);
+    // The document is snapshotted before returning, you can keep modifying it while it's being saved.
+    bool saveAsync(const std::string& xmlFile);
+    bool saveAsync();
+    bool isAsyncBusy() const;
+    // Blocks until the pending operation is done, then applies and notifies it.
+    void waitForAsync();
+    const AsyncStats& getAsyncStats() const;
+
     pugi::xml_parse_result load(const std::string & path);
 
     bool save(const std::string & path);
@@ -108,12 +271,94 @@ public:
 
     void setAttribute(const std::string& tag, const std::string& attribute, const std::string& value);
 
+    // Indexed child lookup (disabled by default)
+    // When enabled, the children of a node are indexed by tag name the first time they're accessed.
+    // `which` lookups and getNumTags() become O(1) instead of walking all children.
+    // The index is invalidated by addTag(), setValue() and removeTag().
+    void setUseChildIndex(bool useIndex);
+    bool getUseChildIndex() const;
+
+    // Drops all indexes. Call this if you modify the document without using this class.
+    void invalidateChildIndex();
+
+#ifndef PUGIXML_NO_XPATH
+    // XPath queries, relative to the current (pushed) tag.
+    // Compiled queries are cached, repeated queries only cost their evaluation. See ofxPugiXml::XPathCache.
+    pugi::xpath_node_set selectNodes(const std::string& expression, const ofxPugiXml::XPathVariables* variables = nullptr);
+    pugi::xpath_node selectNode(const std::string& expression, const ofxPugiXml::XPathVariables* variables = nullptr);
+    // Reads the first result into a helper type (glm vectors, ofFloatColor, base types...)
+    template<typename TYPE>
+    bool getXPathValue(const std::string& expression, TYPE& value, const ofxPugiXml::XPathVariables* variables = nullptr){
+        return this->xpathCache.getValue(this->getXPathContext(), expression.c_str(), value, variables);
+    }
+    template<typename TYPE>
+    bool getXPathValues(const std::string& expression, std::vector<TYPE>& values, const ofxPugiXml::XPathVariables* variables = nullptr){
+        return this->xpathCache.getValues(this->getXPathContext(), expression.c_str(), values, variables);
+    }
+    ofxPugiXml::XPathCache& getXPathCache();
+#endif
+
     pugi::xml_parse_result isFileLoaded;
     std::string filepath;
 
 protected:
 
+    // Declared before doc so it's destroyed after it
+    std::shared_ptr<ofxPugiXml::MappedFile> mappedFile;
+
     pugi::xml_document doc;
     pugi::xml_node currentNode;
 
+    // Returns the `which`-th child of the current node named `tag`
+    pugi::xml_node findChild(const std::string& tag, int which) const;
+    // Returns the indexed children of the current node named `tag`, builds the index if needed.
+    const std::vector<pugi::xml_node>& getIndexedChildren(const std::string& tag) const;
+    void invalidateChildIndex(const pugi::xml_node& node);
+
+#ifndef PUGIXML_NO_XPATH
+    ofxPugiXml::XPathCache xpathCache;
+    pugi::xml_node getXPathContext() const;
+#endif
+
+    // Async operations
+    struct AsyncJob {
+        AsyncResult result;
+        std::unique_ptr<pugi::xml_document> loadedDoc;
+    };
+    std::future<AsyncJob> asyncJob;
+    AsyncStats asyncStats;
+    bool startAsync(std::future<AsyncJob>&& job);
+    void onAsyncUpdate(ofEventArgs& args);
+    void completeAsync();
+
+    // Called by all mutators with the node whose value, attributes or children changed (before removing children)
+    void modified(const pugi::xml_node& node);
+    // Called after (re)loading xmlFile into doc
+    void loaded(const std::string& xmlFile, bool success);
+    void markClean(const std::string& xmlFile);
+    bool writeJournal(const std::string& xmlFile);
+    bool replayJournal(const std::string& xmlFile);
+
+    bool dirty = false;
+    std::string savedPath; // the file doc matches when not dirty
+    std::uint64_t modificationCount = 0;
+    std::uint64_t asyncSaveModificationCount = 0;
+    bool asyncSavePending = false;
+    bool useJournal = false;
+    bool useSnapshot = false;
+    bool fullWriteNeeded = false; // some changes aren't tracked in dirtyNodes
+    std::vector<pugi::xml_node> dirtyNodes; // roots of the modified subtrees, for the journal
+
+    mutable ofxPugiXml::HashCache hashCache;
+
+    // Compiled paths
+    friend class ofxPugiXmlParameterMirror; // uses the same path syntax
+    static bool parsePath(const std::string& path, std::vector<PathSegment>& segments, std::string& attribute);
+    pugi::xml_node resolvePath(const std::vector<PathSegment>& segments) const;
+    std::uint64_t generation = 1; // bumped by any change to the document, invalidates the Path handles
+
+    typedef std::unordered_map<std::string, std::vector<pugi::xml_node> > ChildIndex;
+    mutable std::unordered_map<pugi::xml_node_struct*, ChildIndex> childIndexes;
+    bool useChildIndex = false;
+
 };
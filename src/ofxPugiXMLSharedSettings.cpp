@@ -0,0 +1,356 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofxPugiXMLSharedSettings.h"
+#include "ofMain.h"
+#include <algorithm>
+#include <cassert>
+
+
+ofxPugiXmlSharedSettings::ofxPugiXmlSharedSettings() : current(nullptr), versionNumber(0), writerThread(std::thread::id()), readerSlots(nullptr) {
+    Record* record = new Record();
+    record->version = std::make_shared<const pugi::xml_document>();
+    this->current.store(record);
+}
+
+ofxPugiXmlSharedSettings::~ofxPugiXmlSharedSettings() {
+    // Sessions don't outlive their shared settings
+    delete this->current.load();
+    for(const Record* record : this->retiredRecords) delete record;
+    ReaderSlot* slot = this->readerSlots.load();
+    while(slot != nullptr){
+        ReaderSlot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+void ofxPugiXmlSharedSettings::assertNotWriting() const{
+    assert(this->writerThread.load() != std::this_thread::get_id() && "This thread holds a writer session, it would wait for itself.");
+}
+
+pugi::xml_parse_result ofxPugiXmlSharedSettings::loadFile(const std::string& xmlFile, unsigned int parseOptions, pugi::xml_encoding encoding){
+    // Parse before locking, writers don't have to wait for it
+    std::unique_ptr<pugi::xml_document> doc(new pugi::xml_document());
+    pugi::xml_parse_result result = ofxPugiXml::loadFileInPlace(*doc, xmlFile, parseOptions, encoding);
+    if(result){
+        this->assertNotWriting();
+        std::lock_guard<std::mutex> lock(this->writeMutex);
+        this->publishLocked(std::move(doc));
+    }
+    return result;
+}
+
+bool ofxPugiXmlSharedSettings::saveFile(const std::string& xmlFile) const{
+    Version version = this->getVersion();
+    return ofxPugiXml::saveFileAtomic(*version, xmlFile);
+}
+
+void ofxPugiXmlSharedSettings::publish(const pugi::xml_document& doc){
+    std::unique_ptr<pugi::xml_document> copy(new pugi::xml_document());
+    copy->reset(doc);
+    this->assertNotWriting();
+    std::lock_guard<std::mutex> lock(this->writeMutex);
+    this->publishLocked(std::move(copy));
+}
+
+void ofxPugiXmlSharedSettings::publishLocked(std::unique_ptr<pugi::xml_document>&& doc){
+    Record* record = new Record();
+    record->version = Version(doc.release());
+    record->number = this->versionNumber.load(std::memory_order_relaxed) + 1;
+    const Record* previous = this->current.exchange(record);
+    // After the exchange : a reader seeing this number gets this version or a newer one
+    this->versionNumber.store(record->number, std::memory_order_release);
+
+    // Readers may still be copying the previous reference : retire it, it's freed here once they're done
+    this->retiredRecords.push_back(previous);
+    this->collectLocked();
+}
+
+void ofxPugiXmlSharedSettings::collectLocked(){
+    // Records no reader protects anymore : nobody can acquire a new reference to their version.
+    // A slot acquired during the scan protects the current record, which isn't retired.
+    ReaderSlot* slots = this->readerSlots.load();
+    this->retiredRecords.erase(std::remove_if(this->retiredRecords.begin(), this->retiredRecords.end(), [this, slots](const Record* record){
+        for(const ReaderSlot* slot = slots; slot != nullptr; slot = slot->next){
+            if(slot->hazard.load() == record) return false;
+        }
+        this->retired.push_back(record->version);
+        delete record;
+        return true;
+    }), this->retiredRecords.end());
+    this->retired.erase(std::remove_if(this->retired.begin(), this->retired.end(), [](const Version& retiredVersion){
+        // 1 means it's only referenced here : no reader uses it anymore
+        return retiredVersion.use_count() == 1;
+    }), this->retired.end());
+}
+
+ofxPugiXmlSharedSettings::Version ofxPugiXmlSharedSettings::getVersion() const{
+    // Same protocol as ReadSession::refresh(), with a slot held for the copy only
+    ReaderSlot* slot = this->acquireSlot();
+    Version version = this->protect(slot)->version;
+    this->releaseSlot(slot);
+    return version;
+}
+
+const ofxPugiXmlSharedSettings::Record* ofxPugiXmlSharedSettings::protect(ReaderSlot* slot) const{
+    // Protect the record in the slot, then check it's still published : writers don't free protected records
+    const Record* record = nullptr;
+    do {
+        record = this->current.load();
+        slot->hazard.store(record);
+    } while(record != this->current.load());
+    return record;
+}
+
+ofxPugiXmlSharedSettings::ReaderSlot* ofxPugiXmlSharedSettings::acquireSlot() const{
+    for(ReaderSlot* slot = this->readerSlots.load(); slot != nullptr; slot = slot->next){
+        bool isUsed = false;
+        if(!slot->isUsed.load(std::memory_order_relaxed) && slot->isUsed.compare_exchange_strong(isUsed, true)) return slot;
+    }
+    // All used : push a new one (born used)
+    ReaderSlot* slot = new ReaderSlot();
+    slot->next = this->readerSlots.load();
+    while(!this->readerSlots.compare_exchange_weak(slot->next, slot)){}
+    return slot;
+}
+
+void ofxPugiXmlSharedSettings::releaseSlot(ReaderSlot* slot) const{
+    slot->hazard.store(nullptr);
+    slot->isUsed.store(false, std::memory_order_release);
+}
+
+std::uint64_t ofxPugiXmlSharedSettings::getVersionNumber() const{
+    return this->versionNumber.load(std::memory_order_acquire);
+}
+
+void ofxPugiXmlSharedSettings::collect(){
+    this->assertNotWriting();
+    std::lock_guard<std::mutex> lock(this->writeMutex);
+    this->collectLocked();
+}
+
+ofxPugiXmlSharedSettings::ReadSession ofxPugiXmlSharedSettings::read() const{
+    ReadSession session;
+    session.shared = this;
+    session.slot = this->acquireSlot();
+    session.refresh();
+    return session;
+}
+
+ofxPugiXmlSharedSettings::WriterSession ofxPugiXmlSharedSettings::write(){
+    this->assertNotWriting();
+    return WriterSession(*this);
+}
+
+// Session (cursor and reads)
+pugi::xml_node ofxPugiXmlSharedSettings::Session::findChild(const std::string& tag, int which) const{
+    if(which < 0) which = 0;
+    pugi::xml_node child = this->currentNode.child(tag.c_str());
+    for(int i = 0; i < which && child; ++i) child = child.next_sibling(tag.c_str());
+    return child;
+}
+
+bool ofxPugiXmlSharedSettings::Session::pushTag(const std::string& tag, int which){
+    if(pugi::xml_node child = this->findChild(tag, which)){
+        this->currentNode = child;
+        return true;
+    }
+    return false;
+}
+
+void ofxPugiXmlSharedSettings::Session::popTag(){
+    // Stay at the root, like an empty stack
+    if(this->currentNode.parent()) this->currentNode = this->currentNode.parent();
+}
+
+int ofxPugiXmlSharedSettings::Session::getNumTags(const std::string& tag) const{
+    int counter = 0;
+    for(pugi::xml_node child = this->currentNode.child(tag.c_str()); child; child = child.next_sibling(tag.c_str())) counter++;
+    return counter;
+}
+
+bool ofxPugiXmlSharedSettings::Session::tagExists(const std::string& tag, int which) const{
+    return !this->findChild(tag, which).empty();
+}
+
+int ofxPugiXmlSharedSettings::Session::getValue(const std::string& tag, int defaultValue, int which) const{
+    return this->findChild(tag, which).text().as_int(defaultValue);
+}
+
+double ofxPugiXmlSharedSettings::Session::getValue(const std::string& tag, double defaultValue, int which) const{
+    return this->findChild(tag, which).text().as_double(defaultValue);
+}
+
+std::string ofxPugiXmlSharedSettings::Session::getValue(const std::string& tag, const std::string& defaultValue, int which) const{
+    return this->findChild(tag, which).text().as_string(defaultValue.c_str());
+}
+
+int ofxPugiXmlSharedSettings::Session::getNumAttributes(const std::string& tag, int which) const{
+    int numAttributes = 0;
+    pugi::xml_node child = this->findChild(tag, which);
+    for(pugi::xml_attribute attr = child.first_attribute(); attr; attr = attr.next_attribute()) numAttributes++;
+    return numAttributes;
+}
+
+int ofxPugiXmlSharedSettings::Session::getAttribute(const std::string& tag, const std::string& attribute, int defaultValue, int which) const{
+    return this->findChild(tag, which).attribute(attribute.c_str()).as_int(defaultValue);
+}
+
+double ofxPugiXmlSharedSettings::Session::getAttribute(const std::string& tag, const std::string& attribute, double defaultValue, int which) const{
+    return this->findChild(tag, which).attribute(attribute.c_str()).as_double(defaultValue);
+}
+
+std::string ofxPugiXmlSharedSettings::Session::getAttribute(const std::string& tag, const std::string& attribute, const std::string& defaultValue, int which) const{
+    return this->findChild(tag, which).attribute(attribute.c_str()).as_string(defaultValue.c_str());
+}
+
+// ReadSession
+ofxPugiXmlSharedSettings::ReadSession::ReadSession(ReadSession&& _other) : Session(_other), shared(_other.shared), slot(_other.slot), version(std::move(_other.version)), versionNumber(_other.versionNumber) {
+    _other.shared = nullptr;
+    _other.slot = nullptr;
+    _other.currentNode = pugi::xml_node();
+}
+
+ofxPugiXmlSharedSettings::ReadSession& ofxPugiXmlSharedSettings::ReadSession::operator=(ReadSession&& _other){
+    if(this == &_other) return *this;
+    this->release();
+    this->currentNode = _other.currentNode;
+    this->shared = _other.shared;
+    this->slot = _other.slot;
+    this->version = std::move(_other.version);
+    this->versionNumber = _other.versionNumber;
+    _other.shared = nullptr;
+    _other.slot = nullptr;
+    _other.currentNode = pugi::xml_node();
+    return *this;
+}
+
+ofxPugiXmlSharedSettings::ReadSession::~ReadSession(){
+    this->release();
+}
+
+void ofxPugiXmlSharedSettings::ReadSession::release(){
+    if(this->slot != nullptr) this->shared->releaseSlot(this->slot);
+    this->slot = nullptr;
+    this->shared = nullptr;
+    this->currentNode = pugi::xml_node();
+    // The version is retired (or still published) : a writer frees it, not this thread
+    this->version.reset();
+}
+
+bool ofxPugiXmlSharedSettings::ReadSession::refresh(){
+    if(this->shared == nullptr) return false;
+    if(this->version && this->versionNumber == this->shared->getVersionNumber()) return false;
+
+    const Record* record = this->shared->protect(this->slot);
+    const std::uint64_t number = record->number;
+    Version latest = record->version;
+    this->slot->hazard.store(nullptr, std::memory_order_release);
+
+    this->versionNumber = number;
+    if(latest == this->version) return false;
+    // The previous version is released here, but it's retired : a writer frees it, not this thread
+    this->version.swap(latest);
+    this->currentNode = this->version->root();
+    return true;
+}
+
+bool ofxPugiXmlSharedSettings::ReadSession::isLatest() const{
+    return this->shared == nullptr || this->versionNumber == this->shared->getVersionNumber();
+}
+
+// WriterSession
+ofxPugiXmlSharedSettings::WriterSession::WriterSession(ofxPugiXmlSharedSettings& _shared) : shared(&_shared), lock(_shared.writeMutex) {
+    this->shared->writerThread.store(std::this_thread::get_id());
+    this->doc.reset(new pugi::xml_document());
+    // Holding writeMutex, the current record can't be freed
+    this->doc->reset(*this->shared->current.load()->version);
+    this->currentNode = this->doc->root();
+}
+
+ofxPugiXmlSharedSettings::WriterSession::~WriterSession() {
+    // Moved from or committed sessions don't own the lock anymore
+    if(this->lock.owns_lock()) this->shared->writerThread.store(std::thread::id());
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::commit(){
+    if(!this->doc) return;
+    this->currentNode = pugi::xml_node();
+    this->shared->publishLocked(std::move(this->doc));
+    this->shared->writerThread.store(std::thread::id());
+    this->lock.unlock();
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setText(const std::string& tag, const char* value, int which){
+    pugi::xml_node child = this->findChild(tag, which);
+    if(!child && which <= 0) child = this->currentNode.append_child(tag.c_str());
+    child.text().set(value);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setValue(const std::string& tag, int value, int which){
+    this->setText(tag, ofToString(value).c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setValue(const std::string& tag, double value, int which){
+    this->setText(tag, ofToString(value).c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setValue(const std::string& tag, const std::string& value, int which){
+    this->setText(tag, value.c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::addTag(const std::string& tag){
+    this->currentNode.append_child(tag.c_str());
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::removeTag(const std::string& tag, int which){
+    if(pugi::xml_node child = this->findChild(tag, which)) this->currentNode.remove_child(child);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setAttributeValue(const std::string& tag, const std::string& attribute, const char* value, int which){
+    pugi::xml_node child = this->findChild(tag, which);
+    if(!child) return;
+    pugi::xml_attribute attr = child.attribute(attribute.c_str());
+    if(!attr) attr = child.append_attribute(attribute.c_str());
+    attr.set_value(value);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setAttribute(const std::string& tag, const std::string& attribute, int value, int which){
+    this->setAttributeValue(tag, attribute, ofToString(value).c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setAttribute(const std::string& tag, const std::string& attribute, double value, int which){
+    this->setAttributeValue(tag, attribute, ofToString(value).c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::setAttribute(const std::string& tag, const std::string& attribute, const std::string& value, int which){
+    this->setAttributeValue(tag, attribute, value.c_str(), which);
+}
+
+void ofxPugiXmlSharedSettings::WriterSession::removeAttribute(const std::string& tag, const std::string& attribute, int which){
+    this->findChild(tag, which).remove_attribute(attribute.c_str());
+}
@@ -0,0 +1,212 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLFileUtils.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Settings shared between threads
+// The document is published as immutable versions (copy-on-write / RCU) :
+// - Any number of threads open a ReadSession : it pins the current version and has its own cursor (pushTag/popTag).
+//   Reads don't touch any shared state and never wait for writers. refresh() moves to the latest version : it's
+//   lock-free (an atomic pointer protected by the session's hazard slot, and a reference count increment).
+// - Writes go through a WriterSession : it copies the current version, is modified like ofxPugiXmlSettings,
+//   and commit() publishes it for the next refreshes. Writer sessions are serialized (one at a time).
+// Old versions are freed by writers (on commit or collect()), never by readers : a real-time thread dropping
+// a version doesn't pay for freeing a whole document.
+// getVersion(), saveFile() and read sessions never lock, but opening the first sessions allocates their hazard slots :
+// open the sessions of real-time threads beforehand and keep them.
+// A thread holding a WriterSession must not call write(), publish(), loadFile() or collect() : they wait for the
+// session to end (debug builds assert).
+// Usage :
+//     ofxPugiXmlSharedSettings shared;
+//     shared.loadFile("settings.xml");
+//     // audio thread, keeps its session :
+//     session.refresh();
+//     if(session.pushTag("audio")){ gain = session.getValue("gain", 1.0); session.popTag(); }
+//     // main thread :
+//     ofxPugiXmlSharedSettings::WriterSession writer = shared.write();
+//     if(writer.pushTag("audio")){ writer.setValue("gain", 0.5); writer.popTag(); }
+//     writer.commit();
+// Note : each commit copies the document, batch your changes in one writer session.
+class ofxPugiXmlSharedSettings {
+public:
+    typedef std::shared_ptr<const pugi::xml_document> Version;
+
+    ofxPugiXmlSharedSettings();
+    ~ofxPugiXmlSharedSettings();
+    ofxPugiXmlSharedSettings(const ofxPugiXmlSharedSettings&) = delete;
+    ofxPugiXmlSharedSettings& operator=(const ofxPugiXmlSharedSettings&) = delete;
+
+    // Parses a file into a new version and publishes it (unless it fails)
+    pugi::xml_parse_result loadFile(const std::string& xmlFile, unsigned int parseOptions = pugi::parse_default, pugi::xml_encoding encoding = pugi::encoding_auto);
+    // Saves the current version atomically (see ofxPugiXml::saveFileAtomic)
+    bool saveFile(const std::string& xmlFile) const;
+    // Publishes a copy of a document
+    void publish(const pugi::xml_document& doc);
+
+    // Lock-free, but it increments the version's reference count : real-time threads rather keep a ReadSession
+    Version getVersion() const;
+    // Incremented by every publication
+    std::uint64_t getVersionNumber() const;
+    // Frees the retired versions no reader uses anymore (waits for the active writer session)
+    void collect();
+
+    // Cursor and read accessors shared by both sessions, behaving like ofxPugiXmlSettings'
+    class Session {
+    public:
+        bool pushTag(const std::string& tag, int which = 0);
+        void popTag();
+        int getNumTags(const std::string& tag) const;
+        bool tagExists(const std::string& tag, int which = 0) const;
+
+        int getValue(const std::string& tag, int defaultValue, int which = 0) const;
+        double getValue(const std::string& tag, double defaultValue, int which = 0) const;
+        std::string getValue(const std::string& tag, const std::string& defaultValue, int which = 0) const;
+
+        int getNumAttributes(const std::string& tag, int which = 0) const;
+        int getAttribute(const std::string& tag, const std::string& attribute, int defaultValue, int which = 0) const;
+        double getAttribute(const std::string& tag, const std::string& attribute, double defaultValue, int which = 0) const;
+        std::string getAttribute(const std::string& tag, const std::string& attribute, const std::string& defaultValue, int which = 0) const;
+
+        // The current (pushed) tag, for the ofxPugiXml helpers
+        pugi::xml_node getCurrentNode() const { return currentNode; }
+
+    protected:
+        pugi::xml_node findChild(const std::string& tag, int which) const;
+        pugi::xml_node currentNode;
+    };
+
+protected:
+    class ReaderSlot;
+public:
+    class ReadSession : public Session {
+    public:
+        ReadSession(){}
+        ReadSession(ReadSession&& _other);
+        ReadSession& operator=(ReadSession&& _other);
+        ReadSession(const ReadSession&) = delete;
+        ReadSession& operator=(const ReadSession&) = delete;
+        ~ReadSession();
+
+        // Pins the latest version and resets the cursor to its root. Returns true if the version changed.
+        bool refresh();
+        bool isLatest() const;
+        const Version& getVersion() const { return version; }
+        std::uint64_t getVersionNumber() const { return versionNumber; }
+
+    protected:
+        friend class ofxPugiXmlSharedSettings;
+        void release();
+
+        const ofxPugiXmlSharedSettings* shared = nullptr;
+        ReaderSlot* slot = nullptr;
+        Version version;
+        std::uint64_t versionNumber = 0;
+    };
+
+    class WriterSession : public Session {
+    public:
+        WriterSession(WriterSession&&) = default;
+        WriterSession& operator=(WriterSession&&) = default;
+        // Uncommitted changes are discarded
+        ~WriterSession();
+
+        void setValue(const std::string& tag, int value, int which = 0);
+        void setValue(const std::string& tag, double value, int which = 0);
+        void setValue(const std::string& tag, const std::string& value, int which = 0);
+        void addTag(const std::string& tag);
+        void removeTag(const std::string& tag, int which = 0);
+        void setAttribute(const std::string& tag, const std::string& attribute, int value, int which = 0);
+        void setAttribute(const std::string& tag, const std::string& attribute, double value, int which = 0);
+        void setAttribute(const std::string& tag, const std::string& attribute, const std::string& value, int which = 0);
+        void removeAttribute(const std::string& tag, const std::string& attribute, int which = 0);
+
+        // The working copy, for direct modifications
+        pugi::xml_document& getDocument() { return *doc; }
+
+        // Publishes the working copy. The session can't be used afterwards.
+        void commit();
+        bool isActive() const { return doc != nullptr; }
+
+    protected:
+        friend class ofxPugiXmlSharedSettings;
+        WriterSession(ofxPugiXmlSharedSettings& _shared);
+        // Sets a tag's text, appending the tag if needed (at which = 0)
+        void setText(const std::string& tag, const char* value, int which);
+        void setAttributeValue(const std::string& tag, const std::string& attribute, const char* value, int which);
+
+        ofxPugiXmlSharedSettings* shared = nullptr;
+        std::unique_lock<std::mutex> lock;
+        std::unique_ptr<pugi::xml_document> doc;
+    };
+
+    // Sessions can be kept and used by one thread each
+    ReadSession read() const;
+    // Blocks while another writer session is active, on another thread
+    WriterSession write();
+
+protected:
+    // A published version. Readers protect it in their hazard slot while they copy the reference.
+    struct Record {
+        Version version;
+        std::uint64_t number = 0;
+    };
+    // Slots are never freed before the shared settings : they're reused, and found without locking
+    class ReaderSlot {
+    public:
+        std::atomic<const Record*> hazard;
+        std::atomic<bool> isUsed;
+        ReaderSlot* next = nullptr; // set once, before the slot is pushed
+        ReaderSlot() : hazard(nullptr), isUsed(true) {}
+    };
+
+    // writeMutex has to be locked
+    void publishLocked(std::unique_ptr<pugi::xml_document>&& doc);
+    void collectLocked();
+    ReaderSlot* acquireSlot() const;
+    void releaseSlot(ReaderSlot* slot) const;
+    // Copies the current version's reference, protected by slot
+    const Record* protect(ReaderSlot* slot) const;
+    // Debug check : the writer session's thread would wait for itself
+    void assertNotWriting() const;
+
+    std::atomic<const Record*> current;
+    std::atomic<std::uint64_t> versionNumber;
+    mutable std::mutex writeMutex; // serializes writers and guards the retired lists
+    std::vector<const Record*> retiredRecords; // unpublished, maybe still protected by a reader
+    std::vector<Version> retired; // maybe still referenced by a reader
+    std::atomic<std::thread::id> writerThread; // of the active writer session
+    mutable std::atomic<ReaderSlot*> readerSlots; // lock-free list, only grows
+};
@@ -0,0 +1,468 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#include "ofxPugiXMLSnapshot.h"
+#include "ofxPugiXMLHash.h"
+#include "ofFileUtils.h" // ofToDataPath
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace ofxPugiXml {
+
+// File layout : Header, NodeRecord[numNodes], AttributeRecord[numAttributes], char strings[stringsSize], char image[imageSize]
+struct Snapshot::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t sourceSize;
+    std::int64_t sourceModificationTime;
+    std::uint64_t sourceHash;
+    std::uint64_t sourcePathHash;
+    std::uint32_t parseOptions;
+    std::uint32_t encoding;
+    std::uint32_t isKeyed;
+    std::uint32_t imageParseOptions;
+    std::uint64_t numNodes;
+    std::uint64_t numAttributes;
+    std::uint64_t stringsSize;
+    std::uint64_t nodesOffset;
+    std::uint64_t attributesOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t imageSize;
+    std::uint64_t imageOffset;
+};
+
+// Nodes are stored in document order (pre-order) : parents come before their children, siblings in order.
+// Names and values are offsets in the string table, 0 is the empty string.
+struct Snapshot::NodeRecord {
+    std::uint32_t type;
+    std::uint32_t name;
+    std::uint32_t value;
+    std::uint32_t parent;
+    std::uint32_t firstChild;
+    std::uint32_t nextSibling;
+    std::uint32_t firstAttribute;
+    std::uint32_t numAttributes;
+};
+
+struct Snapshot::AttributeRecord {
+    std::uint32_t name;
+    std::uint32_t value;
+};
+
+namespace {
+    const char snapshotMagic[8] = { 'O', 'F', 'X', 'P', 'U', 'G', 'I', 'S' };
+    const std::uint32_t snapshotVersion = 3;
+    const std::uint32_t snapshotByteOrder = 0x01020304;
+    const std::uint32_t noIndex = 0xffffffff;
+
+    inline std::uint64_t alignOffset(std::uint64_t offset){
+        return (offset + 7) & ~std::uint64_t(7);
+    }
+
+    std::uint64_t hashPath(const std::string& path){
+        const std::string fullPath = ofToDataPath(path, true);
+        return hashBytes(fullPath.data(), fullPath.size());
+    }
+
+    bool hashFile(const std::string& path, std::uint64_t& hash){
+        MappedFile file;
+        if(!file.open(path)) return false;
+        file.advise(MappedFileAccess::Sequential);
+        hash = hashBytes(file.getData(), file.getSize());
+        return true;
+    }
+
+    // Deduplicated string table. Values are only deduplicated when short : long ones are rarely repeated.
+    class StringTable {
+    public:
+        StringTable(){ data.push_back('\0'); }
+
+        bool add(const char* text, std::uint32_t& offset, bool deduplicate){
+            const std::size_t length = std::strlen(text);
+            if(length == 0){
+                offset = 0;
+                return true;
+            }
+            const bool isDeduplicated = deduplicate || length <= 16;
+            const std::uint64_t hash = isDeduplicated ? hashBytes(text, length) : 0;
+            if(isDeduplicated){
+                auto range = offsets.equal_range(hash);
+                for(auto found = range.first; found != range.second; ++found){
+                    if(std::strcmp(&data[found->second], text) == 0){
+                        offset = found->second;
+                        return true;
+                    }
+                }
+            }
+            if(data.size() + length + 1 > noIndex) return false;
+            offset = static_cast<std::uint32_t>(data.size());
+            data.insert(data.end(), text, text + length + 1);
+            if(isDeduplicated) offsets.emplace(hash, offset);
+            return true;
+        }
+
+        std::vector<char> data;
+
+    private:
+        std::unordered_multimap<std::uint64_t, std::uint32_t> offsets; // by content hash
+    };
+
+    class ImageWriter : public pugi::xml_writer {
+    public:
+        void write(const void* data, size_t size) override {
+            const char* bytes = static_cast<const char*>(data);
+            image.insert(image.end(), bytes, bytes + size);
+        }
+        std::vector<char> image;
+    };
+
+    // The image is printed raw (no indentation) from the parsed tree : only the node types and whitespace nodes it
+    // contains are in it, and values are already converted (end of lines, attribute whitespace, trimming).
+    unsigned int getImageParseOptions(const pugi::xml_node& root, unsigned int parseOptions, const std::vector<char>& image){
+        unsigned int options = pugi::parse_pi | pugi::parse_comments | pugi::parse_cdata | pugi::parse_declaration | pugi::parse_doctype | pugi::parse_ws_pcdata;
+        options |= parseOptions & pugi::parse_fragment;
+#if PUGIXML_VERSION >= 190
+        // Since pugixml 1.9
+        options |= parseOptions & pugi::parse_embed_pcdata;
+#endif
+        if(std::memchr(image.data(), '&', image.size()) != nullptr) options |= pugi::parse_escapes;
+        // Without a document element, only a fragment parses
+        bool hasElement = root.type() == pugi::node_element;
+        if(root.type() == pugi::node_document){
+            for(pugi::xml_node child = root.first_child(); child && !hasElement; child = child.next_sibling()) hasElement = child.type() == pugi::node_element;
+        }
+        if(!hasElement) options |= pugi::parse_fragment;
+        return options;
+    }
+}
+
+Snapshot::Snapshot(){
+
+}
+
+Snapshot::~Snapshot(){
+    close();
+}
+
+//--------------------------------------------------------------
+bool Snapshot::save(const pugi::xml_node& _root, const std::string& _path, const std::string& _sourcePath, unsigned int _parseOptions, pugi::xml_encoding _encoding){
+    if(!_root) return false;
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+    header.version = snapshotVersion;
+    header.byteOrder = snapshotByteOrder;
+    header.parseOptions = _parseOptions;
+    header.encoding = static_cast<std::uint32_t>(_encoding);
+    if(!_sourcePath.empty()){
+        if(!getFileInfo(_sourcePath, header.sourceSize, header.sourceModificationTime)) return false;
+        if(!hashFile(_sourcePath, header.sourceHash)) return false;
+        header.sourcePathHash = hashPath(_sourcePath);
+        header.isKeyed = 1;
+    }
+
+    std::vector<NodeRecord> nodes;
+    std::vector<AttributeRecord> attributes;
+    StringTable strings;
+
+    // Iterative pre-order walk, documents can be deeper than the stack
+    std::vector<std::uint32_t> parents;
+    std::vector<std::uint32_t> lastChildren;
+    auto addNode = [&](const pugi::xml_node& node, std::uint32_t parent) -> bool {
+        if(nodes.size() >= noIndex || attributes.size() >= noIndex) return false;
+        NodeRecord record;
+        record.type = static_cast<std::uint32_t>(node.type());
+        record.parent = parent;
+        record.firstChild = noIndex;
+        record.nextSibling = noIndex;
+        record.firstAttribute = static_cast<std::uint32_t>(attributes.size());
+        record.numAttributes = 0;
+        if(!strings.add(node.name(), record.name, true) || !strings.add(node.value(), record.value, false)) return false;
+        for(pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute()){
+            AttributeRecord attribute;
+            if(!strings.add(attr.name(), attribute.name, true) || !strings.add(attr.value(), attribute.value, false)) return false;
+            attributes.push_back(attribute);
+            record.numAttributes++;
+        }
+        nodes.push_back(record);
+        return true;
+    };
+
+    if(!addNode(_root, noIndex)) return false;
+    parents.push_back(0);
+    lastChildren.push_back(noIndex);
+    pugi::xml_node node = _root.first_child();
+    while(node){
+        const std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+        if(!addNode(node, parents.back())) return false;
+        if(lastChildren.back() == noIndex) nodes[parents.back()].firstChild = index;
+        else nodes[lastChildren.back()].nextSibling = index;
+        lastChildren.back() = index;
+
+        if(node.first_child()){
+            parents.push_back(index);
+            lastChildren.push_back(noIndex);
+            node = node.first_child();
+            continue;
+        }
+        // Climb up to the next node in document order
+        while(node != _root && !node.next_sibling()){
+            node = node.parent();
+            parents.pop_back();
+            lastChildren.pop_back();
+        }
+        if(node == _root) break;
+        node = node.next_sibling();
+    }
+
+    // The text image that toDocument() parses in place
+    ImageWriter image;
+    _root.print(image, "", pugi::format_raw | pugi::format_no_declaration, pugi::encoding_utf8);
+    header.imageParseOptions = getImageParseOptions(_root, _parseOptions, image.image);
+
+    header.numNodes = nodes.size();
+    header.numAttributes = attributes.size();
+    header.stringsSize = strings.data.size();
+    header.nodesOffset = alignOffset(sizeof(Header));
+    header.attributesOffset = alignOffset(header.nodesOffset + header.numNodes * sizeof(NodeRecord));
+    header.stringsOffset = alignOffset(header.attributesOffset + header.numAttributes * sizeof(AttributeRecord));
+    header.imageSize = image.image.size();
+    header.imageOffset = alignOffset(header.stringsOffset + header.stringsSize);
+
+    return saveFileAtomic(_path, [&](std::FILE* _file){
+        const char padding[8] = { 0 };
+        std::uint64_t position = 0;
+        auto write = [&](const void* data, std::size_t size, std::uint64_t offset){
+            const std::size_t paddingSize = static_cast<std::size_t>(offset - position);
+            if(std::fwrite(padding, 1, paddingSize, _file) != paddingSize) return false;
+            if(size > 0 && std::fwrite(data, 1, size, _file) != size) return false;
+            position = offset + size;
+            return true;
+        };
+        return write(&header, sizeof(header), 0)
+            && write(nodes.data(), nodes.size() * sizeof(NodeRecord), header.nodesOffset)
+            && write(attributes.data(), attributes.size() * sizeof(AttributeRecord), header.attributesOffset)
+            && write(strings.data.data(), strings.data.size(), header.stringsOffset)
+            && write(image.image.data(), image.image.size(), header.imageOffset);
+    });
+}
+
+//--------------------------------------------------------------
+bool Snapshot::open(const std::string& _path){
+    close();
+    if(!mapping.open(_path)) return false;
+
+    const std::uint64_t size = mapping.getSize();
+    const char* data = static_cast<const char*>(mapping.getData());
+    const Header* candidate = reinterpret_cast<const Header*>(data);
+    const bool isValid = size >= sizeof(Header)
+        && std::memcmp(candidate->magic, snapshotMagic, sizeof(snapshotMagic)) == 0
+        && candidate->version == snapshotVersion
+        && candidate->byteOrder == snapshotByteOrder
+        && candidate->numNodes >= 1 && candidate->numNodes < noIndex
+        && candidate->numAttributes < noIndex
+        && candidate->stringsSize >= 1 && candidate->stringsSize <= noIndex
+        && candidate->nodesOffset % 8 == 0 && candidate->attributesOffset % 8 == 0
+        && candidate->nodesOffset >= sizeof(Header) && candidate->nodesOffset <= size
+        && candidate->numNodes <= (size - candidate->nodesOffset) / sizeof(NodeRecord)
+        && candidate->attributesOffset <= size
+        && candidate->numAttributes <= (size - candidate->attributesOffset) / sizeof(AttributeRecord)
+        && candidate->stringsOffset <= size && candidate->stringsSize <= size - candidate->stringsOffset
+        && data[candidate->stringsOffset + candidate->stringsSize - 1] == '\0'
+        && candidate->imageOffset <= size && candidate->imageSize <= size - candidate->imageOffset;
+    if(!isValid){
+        close();
+        return false;
+    }
+
+    const NodeRecord* nodeRecords = reinterpret_cast<const NodeRecord*>(data + candidate->nodesOffset);
+    const AttributeRecord* attributeRecords = reinterpret_cast<const AttributeRecord*>(data + candidate->attributesOffset);
+
+    // The only pass over the records : links only point forward (or to the parent, backwards), so walks always end
+    const std::uint64_t numNodes = candidate->numNodes;
+    for(std::uint64_t i = 0; i < numNodes; ++i){
+        const NodeRecord& record = nodeRecords[i];
+        const bool isValidNode = record.type <= pugi::node_doctype
+            && record.name < candidate->stringsSize && record.value < candidate->stringsSize
+            && (i == 0 ? record.parent == noIndex : record.parent < i)
+            && (record.firstChild == noIndex || (record.firstChild > i && record.firstChild < numNodes))
+            && (record.nextSibling == noIndex || (record.nextSibling > i && record.nextSibling < numNodes))
+            && std::uint64_t(record.firstAttribute) + record.numAttributes <= candidate->numAttributes;
+        if(!isValidNode){
+            close();
+            return false;
+        }
+    }
+    for(std::uint64_t i = 0; i < candidate->numAttributes; ++i){
+        if(attributeRecords[i].name >= candidate->stringsSize || attributeRecords[i].value >= candidate->stringsSize){
+            close();
+            return false;
+        }
+    }
+
+    header = candidate;
+    nodes = nodeRecords;
+    attributes = attributeRecords;
+    strings = data + candidate->stringsOffset;
+    return true;
+}
+
+void Snapshot::close(){
+    mapping.close();
+    header = nullptr;
+    nodes = nullptr;
+    attributes = nullptr;
+    strings = nullptr;
+}
+
+bool Snapshot::isValidFor(const std::string& _sourcePath, unsigned int _parseOptions, pugi::xml_encoding _encoding) const{
+    if(header == nullptr || !header->isKeyed || header->parseOptions != _parseOptions) return false;
+    if(header->encoding != static_cast<std::uint32_t>(_encoding) || header->sourcePathHash != hashPath(_sourcePath)) return false;
+    std::uint64_t size = 0;
+    std::int64_t modificationTime = 0;
+    if(!getFileInfo(_sourcePath, size, modificationTime) || size != header->sourceSize) return false;
+    if(modificationTime == header->sourceModificationTime) return true;
+    std::uint64_t hash = 0;
+    return hashFile(_sourcePath, hash) && hash == header->sourceHash;
+}
+
+//--------------------------------------------------------------
+bool Snapshot::toDocument(pugi::xml_document& _doc) const{
+    _doc.reset();
+    if(header == nullptr) return false;
+    if(header->imageSize == 0) return true; // an empty document
+
+    // Like loadFileInPlace() : one buffer, allocated by pugi's allocator and owned by the document, names and values
+    // point into it. The image is already converted and only escaped where needed, so parsing it is a light pass.
+    if(header->imageSize > SIZE_MAX) return false;
+    const std::size_t imageSize = static_cast<std::size_t>(header->imageSize);
+    void* buffer = pugi::get_memory_allocation_function()(imageSize);
+    if(buffer == nullptr) return false;
+    std::memcpy(buffer, static_cast<const char*>(mapping.getData()) + header->imageOffset, imageSize);
+    if(!_doc.load_buffer_inplace_own(buffer, imageSize, header->imageParseOptions, pugi::encoding_utf8)){
+        _doc.reset();
+        return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+Snapshot::Node Snapshot::getRoot() const{
+    return makeNode(header != nullptr ? 0 : noIndex);
+}
+
+std::size_t Snapshot::getNumNodes() const{
+    return header != nullptr ? header->numNodes : 0;
+}
+
+std::size_t Snapshot::getNumAttributes() const{
+    return header != nullptr ? header->numAttributes : 0;
+}
+
+Snapshot::Node Snapshot::makeNode(std::uint32_t _index) const{
+    if(_index == noIndex) return Node();
+    return Node(this, _index);
+}
+
+// Node views
+pugi::xml_node_type Snapshot::Node::type() const{
+    if(!snapshot) return pugi::node_null;
+    return static_cast<pugi::xml_node_type>(snapshot->nodes[index].type);
+}
+
+const char* Snapshot::Node::name() const{
+    if(!snapshot) return "";
+    return snapshot->getString(snapshot->nodes[index].name);
+}
+
+const char* Snapshot::Node::value() const{
+    if(!snapshot) return "";
+    return snapshot->getString(snapshot->nodes[index].value);
+}
+
+const char* Snapshot::Node::text() const{
+    for(Node child = firstChild(); child; child = child.nextSibling()){
+        if(child.type() == pugi::node_pcdata || child.type() == pugi::node_cdata) return child.value();
+    }
+    return "";
+}
+
+Snapshot::Node Snapshot::Node::parent() const{
+    if(!snapshot) return Node();
+    return snapshot->makeNode(snapshot->nodes[index].parent);
+}
+
+Snapshot::Node Snapshot::Node::firstChild() const{
+    if(!snapshot) return Node();
+    return snapshot->makeNode(snapshot->nodes[index].firstChild);
+}
+
+Snapshot::Node Snapshot::Node::nextSibling() const{
+    if(!snapshot) return Node();
+    return snapshot->makeNode(snapshot->nodes[index].nextSibling);
+}
+
+Snapshot::Node Snapshot::Node::child(const char* _name) const{
+    for(Node child = firstChild(); child; child = child.nextSibling()){
+        if(std::strcmp(child.name(), _name) == 0) return child;
+    }
+    return Node();
+}
+
+Snapshot::Node Snapshot::Node::nextSibling(const char* _name) const{
+    for(Node sibling = nextSibling(); sibling; sibling = sibling.nextSibling()){
+        if(std::strcmp(sibling.name(), _name) == 0) return sibling;
+    }
+    return Node();
+}
+
+std::size_t Snapshot::Node::getNumAttributes() const{
+    if(!snapshot) return 0;
+    return snapshot->nodes[index].numAttributes;
+}
+
+const char* Snapshot::Node::getAttributeName(std::size_t _attribute) const{
+    if(_attribute >= getNumAttributes()) return "";
+    return snapshot->getString(snapshot->attributes[snapshot->nodes[index].firstAttribute + _attribute].name);
+}
+
+const char* Snapshot::Node::getAttributeValue(std::size_t _attribute) const{
+    if(_attribute >= getNumAttributes()) return "";
+    return snapshot->getString(snapshot->attributes[snapshot->nodes[index].firstAttribute + _attribute].value);
+}
+
+const char* Snapshot::Node::attribute(const char* _name) const{
+    const std::size_t numAttributes = getNumAttributes();
+    for(std::size_t i = 0; i < numAttributes; ++i){
+        if(std::strcmp(getAttributeName(i), _name) == 0) return getAttributeValue(i);
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,133 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLFileUtils.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ofxPugiXml {
+
+    // Binary snapshots of parsed documents
+    // A flat, pointer-free image of a document : a header, the nodes and attributes as arrays of indexes (in document
+    // order), a string table with all names and values (deduplicated), and the document printed raw. The file is
+    // memory-mapped when opened, the only fix-up is the validation of the indexes : nodes and strings are read in place,
+    // without parsing.
+    // Snapshots are keyed to their source file (path, size, modification time and content hash), parse options and
+    // encoding, isValidFor() tells if one still matches the source.
+    // Usage :
+    //     ofxPugiXml::Snapshot snapshot;
+    //     if(snapshot.open("scene.xml.snapshot") && snapshot.isValidFor("scene.xml")) snapshot.toDocument(doc);
+    //     else if(doc.load_file(...)) ofxPugiXml::Snapshot::save(doc, "scene.xml.snapshot", "scene.xml");
+    // Notes :
+    // - Snapshots use the byte order of the machine that wrote them, other machines reject them (rebuild them).
+    // - Up to 4G nodes, attributes and bytes of strings.
+    // - toDocument() parses the raw image in place : it saves the file's formatting, comments and whitespace the parse
+    //   options drop, and the conversions, not the tokenizing. Measure it against loadFileInPlace() on your files
+    //   (example-benchmark : snapshot).
+    class Snapshot {
+    public:
+        Snapshot();
+        ~Snapshot();
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        // Writes _root and its subtree to _path, atomically (see saveFileAtomic). Paths are relative to the data folder.
+        // _sourcePath is the file the document was parsed from (with _parseOptions and _encoding), leave it empty for unkeyed snapshots.
+        static bool save(const pugi::xml_node& _root, const std::string& _path, const std::string& _sourcePath = std::string(), unsigned int _parseOptions = pugi::parse_default, pugi::xml_encoding _encoding = pugi::encoding_auto);
+
+        // Maps a snapshot and validates its layout. False if it's not a (compatible) snapshot.
+        bool open(const std::string& _path);
+        void close();
+        bool isOpen() const { return header != nullptr; }
+
+        // Does the snapshot still match its source ? The path, parse options and encoding have to be the ones it was
+        // saved with, and the size too. If the modification time differs, the content hash is compared (the file was
+        // touched or copied, the contents may still match).
+        bool isValidFor(const std::string& _sourcePath, unsigned int _parseOptions = pugi::parse_default, pugi::xml_encoding _encoding = pugi::encoding_auto) const;
+
+        // Rebuilds the document from the image : one copy into a buffer the document owns, parsed in place (see
+        // loadFileInPlace()). Replaces the contents of _doc.
+        bool toDocument(pugi::xml_document& _doc) const;
+
+        // Read-only view of a node, pointing into the mapping
+        class Node {
+        public:
+            Node(){}
+            explicit operator bool() const { return snapshot != nullptr; }
+            bool operator==(const Node& _other) const { return snapshot == _other.snapshot && index == _other.index; }
+            bool operator!=(const Node& _other) const { return !(*this == _other); }
+
+            pugi::xml_node_type type() const;
+            const char* name() const;
+            const char* value() const;
+            // Value of the first text (pcdata or cdata) child, "" if there's none
+            const char* text() const;
+
+            Node parent() const;
+            Node firstChild() const;
+            Node nextSibling() const;
+            Node child(const char* _name) const;
+            Node nextSibling(const char* _name) const;
+
+            std::size_t getNumAttributes() const;
+            const char* getAttributeName(std::size_t _attribute) const;
+            const char* getAttributeValue(std::size_t _attribute) const;
+            // Value of the named attribute, nullptr if there's none
+            const char* attribute(const char* _name) const;
+
+            std::uint32_t getIndex() const { return index; }
+
+        private:
+            friend class Snapshot;
+            Node(const Snapshot* _snapshot, std::uint32_t _index) : snapshot(_snapshot), index(_index){}
+            const Snapshot* snapshot = nullptr;
+            std::uint32_t index = 0;
+        };
+        Node getRoot() const;
+
+        std::size_t getNumNodes() const;
+        std::size_t getNumAttributes() const;
+        std::size_t getSize() const { return mapping.getSize(); }
+
+    protected:
+        struct Header;
+        struct NodeRecord;
+        struct AttributeRecord;
+
+        Node makeNode(std::uint32_t _index) const;
+        const char* getString(std::uint32_t _offset) const { return strings + _offset; }
+
+        MappedFile mapping;
+        const Header* header = nullptr;
+        const NodeRecord* nodes = nullptr;
+        const AttributeRecord* attributes = nullptr;
+        const char* strings = nullptr;
+    };
+}
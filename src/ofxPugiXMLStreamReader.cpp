@@ -0,0 +1,448 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#include "ofxPugiXMLStreamReader.h"
+#include "ofxPugiXMLFileUtils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+    inline bool isSpace(char c){
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+    // Lenient : anything that can't end a name
+    inline bool isNameChar(char c){
+        return !(isSpace(c) || c == '>' || c == '/' || c == '=' || c == '<' || c == '"' || c == '\'' || c == 0);
+    }
+    inline bool isWhitespaceOnly(const std::string& text){
+        for(char c : text) if(!isSpace(c)) return false;
+        return true;
+    }
+    // Returns the position of seq in [begin, end) or nullptr
+    inline const char* findSequence(const char* begin, const char* end, const char* seq, std::size_t length){
+        const char* found = std::search(begin, end, seq, seq + length);
+        return (found == end) ? nullptr : found;
+    }
+    void appendUtf8(std::string& out, std::uint32_t codepoint){
+        if(codepoint < 0x80){
+            out.push_back(static_cast<char>(codepoint));
+        }else if(codepoint < 0x800){
+            out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }else if(codepoint < 0x10000){
+            out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }else{
+            out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+    // Longest entity we decode : &#x10FFFF;
+    const std::size_t maxEntityLength = 12;
+}
+
+//--------------------------------------------------------------
+ofxPugiXmlStreamReader::ofxPugiXmlStreamReader(){
+    element = scratch.append_child("element");
+    reset();
+}
+
+void ofxPugiXmlStreamReader::setSkipWhitespaceText(bool skip){
+    skipWhitespaceText = skip;
+}
+
+void ofxPugiXmlStreamReader::setMaxTextChunk(std::size_t size){
+    maxTextChunk = std::max<std::size_t>(size, 1);
+}
+
+void ofxPugiXmlStreamReader::reset(){
+    pending.clear();
+    pendingPos = 0;
+    consumedBytes = 0;
+    openElements.clear();
+    text.clear();
+    textRunStarted = false;
+    sawRootElement = false;
+    stopped = false;
+    checkedBOM = false;
+    result = ofxPugiXml::makeParseResult(pugi::status_ok);
+    result.encoding = pugi::encoding_utf8;
+}
+
+void ofxPugiXmlStreamReader::stop(){
+    stopped = true;
+}
+
+bool ofxPugiXmlStreamReader::isStopped() const {
+    return stopped;
+}
+
+const pugi::xml_parse_result& ofxPugiXmlStreamReader::getResult() const {
+    return result;
+}
+
+void ofxPugiXmlStreamReader::setError(pugi::xml_parse_status status, const char* at){
+    result.status = status;
+    result.offset = static_cast<std::ptrdiff_t>(consumedBytes + (at - pending.data()));
+}
+
+//--------------------------------------------------------------
+bool ofxPugiXmlStreamReader::feed(const char* data, std::size_t size){
+    if(stopped || result.status != pugi::status_ok) return false;
+
+    pending.append(data, size);
+    const bool ret = process(false);
+
+    // Drop consumed bytes, only the incomplete token stays in memory
+    if(pendingPos > 0){
+        pending.erase(0, pendingPos);
+        consumedBytes += pendingPos;
+        pendingPos = 0;
+    }
+    return ret;
+}
+
+pugi::xml_parse_result ofxPugiXmlStreamReader::finish(){
+    if(stopped || result.status != pugi::status_ok) return result;
+
+    if(process(true)){
+        flushText(true);
+        const char* end = pending.data() + pending.size();
+        if(!openElements.empty()) setError(pugi::status_end_element_mismatch, end);
+        else if(!sawRootElement) setError(pugi::status_no_document_element, end);
+    }
+    return result;
+}
+
+pugi::xml_parse_result ofxPugiXmlStreamReader::parseFile(const std::string& path, std::size_t chunkSize){
+    reset();
+
+    std::FILE* file = std::fopen(ofToDataPath(path).c_str(), "rb");
+    if(file == nullptr){
+        result.status = pugi::status_file_not_found;
+        return result;
+    }
+
+    std::vector<char> chunk(std::max<std::size_t>(chunkSize, 1));
+    while(true){
+        const std::size_t readSize = std::fread(chunk.data(), 1, chunk.size(), file);
+        if(readSize > 0 && !feed(chunk.data(), readSize)) break;
+        if(readSize < chunk.size()){
+            if(std::ferror(file)) result.status = pugi::status_io_error;
+            break;
+        }
+    }
+    std::fclose(file);
+
+    return finish();
+}
+
+pugi::xml_parse_result ofxPugiXmlStreamReader::parseBuffer(const ofBuffer& buffer, std::size_t chunkSize){
+    reset();
+
+    chunkSize = std::max<std::size_t>(chunkSize, 1);
+    for(std::size_t offset = 0; offset < buffer.size(); offset += chunkSize){
+        if(!feed(buffer.getData() + offset, std::min(chunkSize, buffer.size() - offset))) break;
+    }
+    return finish();
+}
+
+//--------------------------------------------------------------
+bool ofxPugiXmlStreamReader::process(bool isFinal){
+    if(!checkedBOM){
+        if(pending.size() < 3 && !isFinal) return true;
+        if(pending.compare(0, 3, "\xEF\xBB\xBF") == 0) pendingPos = 3;
+        checkedBOM = true;
+    }
+
+    while(pendingPos < pending.size() && !stopped && result.status == pugi::status_ok){
+        const char* begin = pending.data() + pendingPos;
+        const char* end = pending.data() + pending.size();
+
+        const std::size_t consumed = (*begin == '<') ? parseMarkup(begin, end, isFinal) : parseText(begin, end, isFinal);
+        if(consumed == 0) break; // Needs more data (or error)
+        pendingPos += consumed;
+    }
+    return !stopped && result.status == pugi::status_ok;
+}
+
+std::size_t ofxPugiXmlStreamReader::parseText(const char* begin, const char* end, bool isFinal){
+    const char* cursor = begin;
+    while(cursor != end && *cursor != '<'){
+        if(*cursor == '&'){
+            if(!decodeEntity(cursor, end, isFinal, text)) break;
+        }else if(*cursor == '\r'){
+            // Normalise line endings
+            if(cursor + 1 == end && !isFinal) break;
+            text.push_back('\n');
+            ++cursor;
+            if(cursor != end && *cursor == '\n') ++cursor;
+        }else{
+            const char* spanEnd = cursor;
+            while(spanEnd != end && *spanEnd != '<' && *spanEnd != '&' && *spanEnd != '\r') ++spanEnd;
+            text.append(cursor, spanEnd - cursor);
+            cursor = spanEnd;
+        }
+
+        if(text.size() >= maxTextChunk) flushText(false);
+    }
+    return cursor - begin;
+}
+
+bool ofxPugiXmlStreamReader::decodeEntity(const char*& cursor, const char* end, bool isFinal, std::string& out){
+    const char* semicolon = static_cast<const char*>(std::memchr(cursor + 1, ';', std::min<std::size_t>(end - cursor - 1, maxEntityLength)));
+    if(semicolon == nullptr){
+        // Might be cut by the chunk boundary
+        if(!isFinal && static_cast<std::size_t>(end - cursor) <= maxEntityLength) return false;
+        // Not an entity, keep as is (like pugixml)
+        out.push_back('&');
+        ++cursor;
+        return true;
+    }
+
+    const char* name = cursor + 1;
+    const std::size_t length = semicolon - name;
+    bool decoded = true;
+    if(length == 2 && name[0] == 'l' && name[1] == 't') out.push_back('<');
+    else if(length == 2 && name[0] == 'g' && name[1] == 't') out.push_back('>');
+    else if(length == 3 && std::memcmp(name, "amp", 3) == 0) out.push_back('&');
+    else if(length == 4 && std::memcmp(name, "quot", 4) == 0) out.push_back('"');
+    else if(length == 4 && std::memcmp(name, "apos", 4) == 0) out.push_back('\'');
+    else if(length > 1 && name[0] == '#'){
+        const bool hex = (name[1] == 'x');
+        const char* digit = name + (hex ? 2 : 1);
+        std::uint32_t codepoint = 0;
+        decoded = (digit != semicolon);
+        for(; digit != semicolon && decoded; ++digit){
+            const char c = *digit;
+            std::uint32_t value;
+            if(c >= '0' && c <= '9') value = c - '0';
+            else if(hex && c >= 'a' && c <= 'f') value = c - 'a' + 10;
+            else if(hex && c >= 'A' && c <= 'F') value = c - 'A' + 10;
+            else { decoded = false; break; }
+            codepoint = codepoint * (hex ? 16 : 10) + value;
+            if(codepoint > 0x10FFFF) decoded = false;
+        }
+        if(decoded) appendUtf8(out, codepoint);
+    }
+    else decoded = false;
+
+    // Unknown entities are kept as is
+    if(!decoded) out.append(cursor, semicolon + 1 - cursor);
+    cursor = semicolon + 1;
+    return true;
+}
+
+void ofxPugiXmlStreamReader::flushText(bool endOfRun){
+    if(!text.empty()){
+        const bool skip = endOfRun && !textRunStarted && skipWhitespaceText && isWhitespaceOnly(text);
+        if(!skip && onText){
+            onText(text.data(), text.size(), openElements.empty() ? 0 : openElements.size() - 1);
+        }
+        text.clear();
+    }
+    textRunStarted = !endOfRun;
+}
+
+std::size_t ofxPugiXmlStreamReader::parseMarkup(const char* begin, const char* end, bool isFinal){
+    // Any markup ends the current text run
+    flushText(true);
+
+    const std::size_t available = end - begin;
+    // Wait until we can tell comments and CDATA apart
+    if(!isFinal){
+        if(available < 4 && std::memcmp(begin, "<!--", available) == 0) return 0;
+        if(available < 9 && std::memcmp(begin, "<![CDATA[", available) == 0) return 0;
+    }
+    if(available < 2){
+        if(isFinal) setError(pugi::status_unrecognized_tag, begin);
+        return 0;
+    }
+
+    if(available >= 4 && std::memcmp(begin, "<!--", 4) == 0){
+        const char* close = findSequence(begin + 4, end, "-->", 3);
+        if(close == nullptr){
+            if(isFinal) setError(pugi::status_bad_comment, begin);
+            return 0;
+        }
+        return close + 3 - begin;
+    }
+    if(available >= 9 && std::memcmp(begin, "<![CDATA[", 9) == 0){
+        const char* close = findSequence(begin + 9, end, "]]>", 3);
+        if(close == nullptr){
+            if(isFinal) setError(pugi::status_bad_cdata, begin);
+            return 0;
+        }
+        if(onText && close > begin + 9){
+            onText(begin + 9, close - (begin + 9), openElements.empty() ? 0 : openElements.size() - 1);
+        }
+        return close + 3 - begin;
+    }
+    if(begin[1] == '?'){
+        // Declaration or processing instruction, skipped
+        const char* close = findSequence(begin + 2, end, "?>", 2);
+        if(close == nullptr){
+            if(isFinal) setError(pugi::status_bad_pi, begin);
+            return 0;
+        }
+        return close + 2 - begin;
+    }
+    if(begin[1] == '!'){
+        // DOCTYPE, skipped (including its internal subset)
+        int brackets = 0;
+        char quote = 0;
+        for(const char* cursor = begin + 2; cursor != end; ++cursor){
+            const char c = *cursor;
+            if(quote != 0){ if(c == quote) quote = 0; }
+            else if(c == '"' || c == '\'') quote = c;
+            else if(c == '[') ++brackets;
+            else if(c == ']') --brackets;
+            else if(c == '>' && brackets <= 0) return cursor + 1 - begin;
+        }
+        if(isFinal) setError(pugi::status_bad_doctype, begin);
+        return 0;
+    }
+    if(begin[1] == '/') return parseEndTag(begin, end, isFinal);
+    return parseStartTag(begin, end, isFinal);
+}
+
+std::size_t ofxPugiXmlStreamReader::parseEndTag(const char* begin, const char* end, bool isFinal){
+    const char* close = static_cast<const char*>(std::memchr(begin, '>', end - begin));
+    if(close == nullptr){
+        if(isFinal) setError(pugi::status_bad_end_element, begin);
+        return 0;
+    }
+
+    const char* nameEnd = close;
+    while(nameEnd > begin + 2 && isSpace(nameEnd[-1])) --nameEnd;
+    const std::size_t nameLength = nameEnd - (begin + 2);
+
+    if(openElements.empty() || openElements.back().size() != nameLength || openElements.back().compare(0, nameLength, begin + 2, nameLength) != 0){
+        setError(pugi::status_end_element_mismatch, begin);
+        return 0;
+    }
+
+    if(onElementEnd) onElementEnd(openElements.back().c_str(), openElements.size() - 1);
+    openElements.pop_back();
+    return close + 1 - begin;
+}
+
+std::size_t ofxPugiXmlStreamReader::parseStartTag(const char* begin, const char* end, bool isFinal){
+    // Find the closing bracket, ignoring the ones in attribute values
+    const char* close = nullptr;
+    char quote = 0;
+    for(const char* cursor = begin + 1; cursor != end; ++cursor){
+        const char c = *cursor;
+        if(quote != 0){ if(c == quote) quote = 0; }
+        else if(c == '"' || c == '\'') quote = c;
+        else if(c == '>'){ close = cursor; break; }
+    }
+    if(close == nullptr){
+        if(isFinal) setError(pugi::status_bad_start_element, begin);
+        return 0;
+    }
+
+    const bool selfClosing = (close[-1] == '/');
+    const char* tagEnd = selfClosing ? close - 1 : close;
+
+    // Element name
+    const char* cursor = begin + 1;
+    while(cursor < tagEnd && isNameChar(*cursor)) ++cursor;
+    if(cursor == begin + 1){
+        setError(pugi::status_bad_start_element, begin);
+        return 0;
+    }
+    std::string name(begin + 1, cursor);
+
+    // Recycle the scratch element
+    element.set_name(name.c_str());
+    while(pugi::xml_attribute attr = element.first_attribute()) element.remove_attribute(attr);
+
+    // Attributes
+    while(true){
+        while(cursor < tagEnd && isSpace(*cursor)) ++cursor;
+        if(cursor >= tagEnd) break;
+
+        const char* attrNameStart = cursor;
+        while(cursor < tagEnd && isNameChar(*cursor)) ++cursor;
+        if(cursor == attrNameStart){
+            setError(pugi::status_bad_attribute, cursor);
+            return 0;
+        }
+        attributeName.assign(attrNameStart, cursor);
+
+        while(cursor < tagEnd && isSpace(*cursor)) ++cursor;
+        if(cursor >= tagEnd || *cursor != '='){
+            setError(pugi::status_bad_attribute, cursor);
+            return 0;
+        }
+        ++cursor;
+        while(cursor < tagEnd && isSpace(*cursor)) ++cursor;
+        if(cursor >= tagEnd || (*cursor != '"' && *cursor != '\'')){
+            setError(pugi::status_bad_attribute, cursor);
+            return 0;
+        }
+        const char attrQuote = *cursor++;
+        const char* valueEnd = static_cast<const char*>(std::memchr(cursor, attrQuote, tagEnd - cursor));
+        if(valueEnd == nullptr){
+            setError(pugi::status_bad_attribute, cursor);
+            return 0;
+        }
+
+        // Decode entities and convert whitespace to spaces (like pugixml's default parse_wconv_attribute)
+        attributeValue.clear();
+        while(cursor < valueEnd){
+            if(*cursor == '&') decodeEntity(cursor, valueEnd, true, attributeValue);
+            else {
+                const char c = *cursor++;
+                attributeValue.push_back((c == '\t' || c == '\n' || c == '\r') ? ' ' : c);
+            }
+        }
+        cursor = valueEnd + 1;
+
+        element.append_attribute(attributeName.c_str()).set_value(attributeValue.c_str());
+    }
+
+    const std::size_t depth = openElements.size();
+    sawRootElement = true;
+
+    if(onElementStart) onElementStart(element, depth);
+    if(onAttribute){
+        for(pugi::xml_attribute attr = element.first_attribute(); attr && !stopped; attr = attr.next_attribute()){
+            onAttribute(attr, depth);
+        }
+    }
+
+    if(selfClosing){
+        if(onElementEnd) onElementEnd(name.c_str(), depth);
+    }else{
+        openElements.push_back(std::move(name));
+    }
+    return close + 1 - begin;
+}
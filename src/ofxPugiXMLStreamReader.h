@@ -0,0 +1,112 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofFileUtils.h" // ofBuffer
+#include <functional>
+#include <string>
+#include <vector>
+
+// Forward-only streaming XML reader (SAX style), for files too large to be loaded as a DOM.
+// Data is fed in chunks; memory use is bounded by the nesting depth and the largest single tag, not the file size.
+// Each element is handed to onElementStart as a (temporary) pugi node holding its name and attributes,
+// so all the ofxPugiXml getters work on it : `ofxPugiXml::getNodeAttributeValue(element, "pos", myVec3);`
+// Limitations : UTF-8 input only, DTDs are skipped (no custom entities), comments and PIs are skipped.
+class ofxPugiXmlStreamReader {
+
+public:
+
+    ofxPugiXmlStreamReader();
+
+    // Callbacks, all optional. Depth of the root element is 0.
+    // The element node is only valid during the callback.
+    std::function<void(pugi::xml_node& element, std::size_t depth)> onElementStart;
+    std::function<void(pugi::xml_attribute& attribute, std::size_t depth)> onAttribute;
+    // Text and CDATA content, entities are decoded. Long text runs may be delivered in several pieces.
+    std::function<void(const char* text, std::size_t length, std::size_t depth)> onText;
+    std::function<void(const char* name, std::size_t depth)> onElementEnd;
+
+    // Skip whitespace-only text (default true, like pugixml's default parse flags)
+    void setSkipWhitespaceText(bool skip);
+    // Text runs longer than this are delivered in pieces (default 64KB)
+    void setMaxTextChunk(std::size_t size);
+
+    // Incremental interface : feed() any number of chunks, then finish().
+    // feed() returns false once an error occurred or stop() was called.
+    bool feed(const char* data, std::size_t size);
+    pugi::xml_parse_result finish();
+
+    // Convenience : parses a whole file (relative to the data folder) or buffer, in chunks of chunkSize bytes.
+    pugi::xml_parse_result parseFile(const std::string& path, std::size_t chunkSize = 1 << 16);
+    pugi::xml_parse_result parseBuffer(const ofBuffer& buffer, std::size_t chunkSize = 1 << 16);
+
+    // Call from a callback to abort parsing (the result stays ok).
+    void stop();
+    bool isStopped() const;
+
+    // Clears the parsing state (keeps callbacks and settings)
+    void reset();
+
+    const pugi::xml_parse_result& getResult() const;
+
+protected:
+
+    // Parses as many complete tokens as available. Returns false on error or stop.
+    bool process(bool isFinal);
+    // Each returns the number of consumed bytes, 0 if more data is needed, or sets an error.
+    std::size_t parseMarkup(const char* begin, const char* end, bool isFinal);
+    std::size_t parseStartTag(const char* begin, const char* end, bool isFinal);
+    std::size_t parseEndTag(const char* begin, const char* end, bool isFinal);
+    std::size_t parseText(const char* begin, const char* end, bool isFinal);
+    // Appends decoded text to out, returns false if the entity is incomplete.
+    bool decodeEntity(const char*& cursor, const char* end, bool isFinal, std::string& out);
+
+    void flushText(bool endOfRun);
+    // Offset is computed from a position in `pending`
+    void setError(pugi::xml_parse_status status, const char* at);
+
+    std::string pending;       // bytes received but not consumed yet
+    std::size_t pendingPos = 0;
+    std::size_t consumedBytes = 0; // absolute offset of pending[0]
+
+    std::vector<std::string> openElements;
+    std::string text;
+    bool textRunStarted = false;
+    bool sawRootElement = false;
+    bool stopped = false;
+    bool checkedBOM = false;
+
+    bool skipWhitespaceText = true;
+    std::size_t maxTextChunk = 1 << 16;
+
+    // Holds the current element and its attributes
+    pugi::xml_document scratch;
+    pugi::xml_node element;
+    std::string attributeName;
+    std::string attributeValue;
+
+    pugi::xml_parse_result result;
+};
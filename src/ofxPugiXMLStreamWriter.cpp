@@ -0,0 +1,271 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#include "ofxPugiXMLStreamWriter.h"
+#include "ofFileUtils.h" // ofToDataPath
+
+#ifdef _WIN32
+#include <io.h> // _commit
+#else
+#include <unistd.h> // fsync
+#endif
+
+ofxPugiXmlStreamWriter::ofxPugiXmlStreamWriter(){
+
+}
+
+ofxPugiXmlStreamWriter::~ofxPugiXmlStreamWriter(){
+    close();
+}
+
+bool ofxPugiXmlStreamWriter::open(const std::string& path, bool writeDeclaration){
+    close();
+
+    file = std::fopen(ofToDataPath(path).c_str(), "wb");
+    if(file == nullptr) return false;
+    // We do our own buffering
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    buffer.clear();
+    buffer.reserve(bufferSize);
+    bytesWritten = 0;
+    lastCheckpoint = 0;
+    writeError = false;
+    openElements.clear();
+    startTagOpen = false;
+
+    if(writeDeclaration) append("<?xml version=\"1.0\"?>");
+    return true;
+}
+
+bool ofxPugiXmlStreamWriter::close(){
+    if(file == nullptr) return false;
+
+    while(!openElements.empty()) closeElement();
+    append("\n", 1);
+
+    const bool ret = checkpoint();
+    std::fclose(file);
+    file = nullptr;
+    return ret && !writeError;
+}
+
+bool ofxPugiXmlStreamWriter::isOpen() const {
+    return file != nullptr;
+}
+
+void ofxPugiXmlStreamWriter::setBufferSize(std::size_t bytes){
+    bufferSize = (bytes > 0) ? bytes : 1;
+}
+
+void ofxPugiXmlStreamWriter::setIndent(const std::string& _indent){
+    indent = _indent;
+}
+
+void ofxPugiXmlStreamWriter::setAutoCheckpoint(std::uint64_t bytes){
+    autoCheckpointBytes = bytes;
+}
+
+//--------------------------------------------------------------
+bool ofxPugiXmlStreamWriter::flush(){
+    if(file == nullptr) return false;
+    if(!buffer.empty()){
+        if(std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) writeError = true;
+        bytesWritten += buffer.size();
+        buffer.clear();
+    }
+    if(autoCheckpointBytes > 0 && bytesWritten - lastCheckpoint >= autoCheckpointBytes){
+        return checkpoint();
+    }
+    return !writeError;
+}
+
+bool ofxPugiXmlStreamWriter::checkpoint(){
+    if(file == nullptr) return false;
+    if(!buffer.empty()){
+        if(std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) writeError = true;
+        bytesWritten += buffer.size();
+        buffer.clear();
+    }
+    if(std::fflush(file) != 0) writeError = true;
+#ifdef _WIN32
+    if(_commit(_fileno(file)) != 0) writeError = true;
+#else
+    if(fsync(fileno(file)) != 0) writeError = true;
+#endif
+    lastCheckpoint = bytesWritten;
+    return !writeError;
+}
+
+//--------------------------------------------------------------
+void ofxPugiXmlStreamWriter::appendIndent(std::size_t depth){
+    if(indent.empty()) return;
+    append("\n", 1);
+    for(std::size_t i = 0; i < depth; ++i) append(indent.data(), indent.size());
+}
+
+void ofxPugiXmlStreamWriter::appendEscaped(const char* data, std::size_t length, bool isAttribute){
+    const char* spanStart = data;
+    const char* end = data + length;
+    for(const char* cursor = data; cursor != end; ++cursor){
+        const char* entity = nullptr;
+        switch(*cursor){
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': if(isAttribute) entity = "&quot;"; break;
+            case '\n': if(isAttribute) entity = "&#10;"; break;
+            case '\r': entity = "&#13;"; break;
+            case '\t': if(isAttribute) entity = "&#9;"; break;
+            default: break;
+        }
+        if(entity != nullptr){
+            append(spanStart, cursor - spanStart);
+            append(entity);
+            spanStart = cursor + 1;
+        }
+    }
+    append(spanStart, end - spanStart);
+}
+
+void ofxPugiXmlStreamWriter::closeStartTag(){
+    if(!startTagOpen) return;
+    append(">", 1);
+    startTagOpen = false;
+}
+
+bool ofxPugiXmlStreamWriter::openElement(const char* name){
+    if(file == nullptr || name == nullptr || *name == 0) return false;
+
+    closeStartTag();
+    if(!openElements.empty()){
+        openElements.back().hasChildren = true;
+        appendIndent(openElements.size());
+    }
+    else if(getBytesWritten() > 0) append("\n", 1); // after the declaration
+
+    append("<", 1);
+    append(name);
+    startTagOpen = true;
+
+    OpenElement element;
+    element.name = name;
+    openElements.push_back(std::move(element));
+    return true;
+}
+
+bool ofxPugiXmlStreamWriter::closeElement(){
+    if(file == nullptr || openElements.empty()) return false;
+
+    const OpenElement& element = openElements.back();
+    if(startTagOpen){
+        // Empty element
+        append(" />", 3);
+        startTagOpen = false;
+    }else{
+        if(element.hasChildren) appendIndent(openElements.size() - 1);
+        append("</", 2);
+        append(element.name.data(), element.name.size());
+        append(">", 1);
+    }
+    openElements.pop_back();
+    return !writeError;
+}
+
+bool ofxPugiXmlStreamWriter::text(const char* value){
+    if(file == nullptr || openElements.empty() || value == nullptr) return false;
+
+    closeStartTag();
+    appendEscaped(value, std::strlen(value), false);
+    return !writeError;
+}
+
+//--------------------------------------------------------------
+bool ofxPugiXmlStreamWriter::writeAttribute(const char* name, const char* value, std::size_t length){
+    if(file == nullptr || !startTagOpen) return false;
+    // Same fallback as ofxPugiXml::setNodeAttribute()
+    if(name == nullptr || *name == 0) name = "value";
+
+    append(" ", 1);
+    append(name);
+    append("=\"", 2);
+    appendEscaped(value, length, true);
+    append("\"", 1);
+    return !writeError;
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const char* value){
+    if(value == nullptr) value = "";
+    return writeAttribute(name, value, std::strlen(value));
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, float value){
+    char number[32];
+    return writeAttribute(name, number, ofxPugiXml::numberToChars(number, sizeof(number), value));
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, double value){
+    char number[32];
+    return writeAttribute(name, number, ofxPugiXml::numberToChars(number, sizeof(number), value));
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const glm::vec2& value){
+    ofxPugiXml::AttrName attrName(name);
+    bool ret = attribute(attrName.with("x"), value.x);
+    ret &= attribute(attrName.with("y"), value.y);
+    return ret;
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const glm::vec3& value){
+    ofxPugiXml::AttrName attrName(name);
+    bool ret = attribute(attrName.with("x"), value.x);
+    ret &= attribute(attrName.with("y"), value.y);
+    ret &= attribute(attrName.with("z"), value.z);
+    return ret;
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const glm::vec4& value){
+    ofxPugiXml::AttrName attrName(name);
+    bool ret = attribute(attrName.with("x"), value.x);
+    ret &= attribute(attrName.with("y"), value.y);
+    ret &= attribute(attrName.with("z"), value.z);
+    ret &= attribute(attrName.with("w"), value.w);
+    return ret;
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const glm::ivec2& value){
+    ofxPugiXml::AttrName attrName(name);
+    bool ret = attribute(attrName.with("x"), value.x);
+    ret &= attribute(attrName.with("y"), value.y);
+    return ret;
+}
+
+bool ofxPugiXmlStreamWriter::attribute(const char* name, const ofFloatColor& value){
+    ofxPugiXml::AttrName attrName(name);
+    bool ret = attribute(attrName.with("r"), value.r);
+    ret &= attribute(attrName.with("g"), value.g);
+    ret &= attribute(attrName.with("b"), value.b);
+    ret &= attribute(attrName.with("a"), value.a);
+    return ret;
+}
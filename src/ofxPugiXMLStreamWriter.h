@@ -0,0 +1,163 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#pragma once
+
+#include "ofxPugiXMLHelpers.h"
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <charconv>
+#endif
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Streaming XML writer : writes elements as they come, without building a document.
+// Output goes through a bounded buffer to the file, so recordings of any length run in constant memory.
+// Attributes accept the same types as ofxPugiXml::setNodeAttribute() (glm vectors, ofFloatColor, arrays...),
+// using the same attribute naming, so files can be read back with the regular helpers.
+// Usage :
+//     ofxPugiXmlStreamWriter writer;
+//     writer.open("recording.xml");
+//     writer.openElement("events");
+//     writer.openElement("event"); writer.attribute("time", t); writer.attribute("pos", pos); writer.closeElement();
+//     ...
+//     writer.close(); // closes remaining elements
+class ofxPugiXmlStreamWriter {
+
+public:
+
+    ofxPugiXmlStreamWriter();
+    ~ofxPugiXmlStreamWriter();
+    ofxPugiXmlStreamWriter(const ofxPugiXmlStreamWriter&) = delete;
+    ofxPugiXmlStreamWriter& operator=(const ofxPugiXmlStreamWriter&) = delete;
+
+    // Path is relative to the data folder. Overwrites existing files.
+    bool open(const std::string& path, bool writeDeclaration = true);
+    // Closes all open elements, flushes and syncs to disk.
+    bool close();
+    bool isOpen() const;
+
+    // Settings, set them before open()
+    void setBufferSize(std::size_t bytes);  // default 64KB
+    void setIndent(const std::string& indent); // default tab, empty for compact output
+    // Syncs to disk (see checkpoint()) every `bytes` written, 0 disables (default).
+    void setAutoCheckpoint(std::uint64_t bytes);
+
+    bool openElement(const char* name);
+    bool closeElement();
+
+    // Attributes, only valid right after openElement()
+    bool attribute(const char* name, const char* value);
+    bool attribute(const char* name, const std::string& value){ return attribute(name, value.c_str()); }
+    bool attribute(const char* name, bool value){ return attribute(name, value ? "true" : "false"); }
+    bool attribute(const char* name, float value);
+    bool attribute(const char* name, double value);
+    template<typename TYPE>
+    typename std::enable_if<std::is_integral<TYPE>::value && !std::is_same<TYPE, bool>::value, bool>::type
+    attribute(const char* name, TYPE value){
+        char number[24];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        std::to_chars_result result = std::to_chars(number, number + sizeof(number), value);
+        return writeAttribute(name, number, result.ptr - number);
+#else
+        // No <charconv> (C++14 or older standard libraries), integers don't depend on the locale
+        const int length = std::is_signed<TYPE>::value ?
+            std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value)) :
+            std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+        return writeAttribute(name, number, length);
+#endif
+    }
+    bool attribute(const char* name, const glm::vec2& value);
+    bool attribute(const char* name, const glm::vec3& value);
+    bool attribute(const char* name, const glm::vec4& value);
+    bool attribute(const char* name, const glm::ivec2& value);
+    bool attribute(const char* name, const ofFloatColor& value);
+    template<typename TYPE>
+    bool attribute(const char* name, const TYPE (&value)[2]){
+        ofxPugiXml::AttrName attrName(name);
+        bool ret = attribute(attrName.with("v0"), value[0]);
+        ret &= attribute(attrName.with("v1"), value[1]);
+        return ret;
+    }
+    template<typename TYPE>
+    bool attribute(const char* name, const TYPE (&value)[4]){
+        ofxPugiXml::AttrName attrName(name);
+        bool ret = attribute(attrName.with("v0"), value[0]);
+        ret &= attribute(attrName.with("v1"), value[1]);
+        ret &= attribute(attrName.with("v2"), value[2]);
+        ret &= attribute(attrName.with("v3"), value[3]);
+        return ret;
+    }
+
+    // Text content of the current element (escaped)
+    bool text(const char* value);
+    bool text(const std::string& value){ return text(value.c_str()); }
+
+    // Convenience : <name value="..."/>, like ofxPugiXml::setNodeValueToAttribute()
+    template<typename TYPE>
+    bool element(const char* name, const TYPE& value, const char* attrName = ""){
+        bool ret = openElement(name);
+        ret &= attribute(attrName, value);
+        ret &= closeElement();
+        return ret;
+    }
+
+    // Hands buffered data to the OS
+    bool flush();
+    // Flushes and syncs the file to disk : everything written so far survives a crash.
+    // Note: the file only becomes well-formed XML once close() wrote the closing tags.
+    bool checkpoint();
+
+    std::size_t getDepth() const { return openElements.size(); }
+    std::uint64_t getBytesWritten() const { return bytesWritten + buffer.size(); }
+
+protected:
+
+    bool writeAttribute(const char* name, const char* value, std::size_t length);
+    void append(const char* data, std::size_t length){ buffer.append(data, length); if(buffer.size() >= bufferSize) flush(); }
+    void append(const char* data){ append(data, std::strlen(data)); }
+    void appendEscaped(const char* data, std::size_t length, bool isAttribute);
+    void appendIndent(std::size_t depth);
+    // Terminates a pending start tag (`<name attr="..."`) with `>`
+    void closeStartTag();
+
+    std::FILE* file = nullptr;
+    std::string buffer;
+    std::size_t bufferSize = 1 << 16;
+    std::string indent = "\t";
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t autoCheckpointBytes = 0;
+    std::uint64_t lastCheckpoint = 0;
+    bool writeError = false;
+
+    struct OpenElement {
+        std::string name;
+        bool hasChildren = false; // has child elements (closing tag goes on its own line)
+    };
+    std::vector<OpenElement> openElements;
+    bool startTagOpen = false;
+};
@@ -0,0 +1,178 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#include "ofxPugiXMLWriteSession.h"
+#include <cstring>
+
+namespace ofxPugiXml {
+
+static thread_local WriteSession* currentSession = nullptr;
+
+// FNV-1a, 64 bit
+std::uint64_t WriteSession::hashName(const char* _name){
+    std::uint64_t hash = 14695981039346656037ull;
+    for(const unsigned char* c = reinterpret_cast<const unsigned char*>(_name); *c != 0; ++c){
+        hash ^= *c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------------
+void* WriteSession::NameTable::find(const char* _name, std::uint64_t _hash) const {
+    if(slots.empty()) return nullptr;
+    const std::size_t mask = slots.size() - 1;
+    for(std::size_t i = _hash & mask; ; i = (i + 1) & mask){
+        const Slot& slot = slots[i];
+        if(slot.name == nullptr) return nullptr;
+        if(slot.hash == _hash && std::strcmp(slot.name, _name) == 0) return slot.object;
+    }
+}
+
+void WriteSession::NameTable::insert(const char* _name, std::uint64_t _hash, void* _object){
+    // Keep the load factor under 1/2
+    if((count + 1) * 2 > slots.size()) grow();
+
+    const std::size_t mask = slots.size() - 1;
+    for(std::size_t i = _hash & mask; ; i = (i + 1) & mask){
+        Slot& slot = slots[i];
+        if(slot.name == nullptr){
+            slot.hash = _hash;
+            slot.name = _name;
+            slot.object = _object;
+            ++count;
+            return;
+        }
+        if(slot.hash == _hash && std::strcmp(slot.name, _name) == 0) return;
+    }
+}
+
+void WriteSession::NameTable::grow(){
+    std::vector<Slot> oldSlots;
+    oldSlots.swap(slots);
+    slots.resize(oldSlots.empty() ? 16 : oldSlots.size() * 2);
+
+    const std::size_t mask = slots.size() - 1;
+    for(const Slot& oldSlot : oldSlots){
+        if(oldSlot.name == nullptr) continue;
+        std::size_t i = oldSlot.hash & mask;
+        while(slots[i].name != nullptr) i = (i + 1) & mask;
+        slots[i] = oldSlot;
+    }
+}
+
+//--------------------------------------------------------------
+WriteSession::WriteSession(){
+    previous = currentSession;
+    currentSession = this;
+}
+
+WriteSession::~WriteSession(){
+    currentSession = previous;
+}
+
+WriteSession* WriteSession::getCurrent(){
+    return currentSession;
+}
+
+void WriteSession::clear(){
+    attributeTables.clear();
+    childTables.clear();
+    lastAttributeNode = nullptr;
+    lastAttributeTable = nullptr;
+    lastChildNode = nullptr;
+    lastChildTable = nullptr;
+}
+
+WriteSession::NameTable& WriteSession::getAttributeTable(pugi::xml_node& _node){
+    pugi::xml_node_struct* key = _node.internal_object();
+    if(key == lastAttributeNode && lastAttributeTable != nullptr) return *lastAttributeTable;
+
+    auto found = attributeTables.find(key);
+    if(found == attributeTables.end()){
+        // First write to this node : register what's already there
+        found = attributeTables.emplace(key, NameTable()).first;
+        for(pugi::xml_attribute attr : _node.attributes()){
+            found->second.insert(attr.name(), hashName(attr.name()), attr.internal_object());
+        }
+    }
+    lastAttributeNode = key;
+    lastAttributeTable = &found->second;
+    return found->second;
+}
+
+WriteSession::NameTable& WriteSession::getChildTable(pugi::xml_node& _node){
+    pugi::xml_node_struct* key = _node.internal_object();
+    if(key == lastChildNode && lastChildTable != nullptr) return *lastChildTable;
+
+    auto found = childTables.find(key);
+    if(found == childTables.end()){
+        found = childTables.emplace(key, NameTable()).first;
+        for(pugi::xml_node child : _node.children()){
+            if(child.type() != pugi::node_element) continue;
+            found->second.insert(child.name(), hashName(child.name()), child.internal_object());
+        }
+    }
+    lastChildNode = key;
+    lastChildTable = &found->second;
+    return found->second;
+}
+
+pugi::xml_attribute WriteSession::getOrAppendAttribute(pugi::xml_node& _node, const char* _attrName){
+    if(!_node) return pugi::xml_attribute();
+    return getOrAppendAttribute(_node, _attrName, hashName(_attrName));
+}
+
+pugi::xml_attribute WriteSession::getOrAppendAttribute(pugi::xml_node& _node, const char* _attrName, std::uint64_t _hash){
+    // Like append_attribute() on an empty node
+    if(!_node) return pugi::xml_attribute();
+    NameTable& table = getAttributeTable(_node);
+    if(void* existing = table.find(_attrName, _hash)){
+        return pugi::xml_attribute(static_cast<pugi::xml_attribute_struct*>(existing));
+    }
+
+    pugi::xml_attribute attr = _node.append_attribute(_attrName);
+    // Use pugi's copy of the name as key, _attrName may be a temporary
+    if(attr) table.insert(attr.name(), _hash, attr.internal_object());
+    return attr;
+}
+
+pugi::xml_node WriteSession::getOrAppendNode(pugi::xml_node& _parentNode, const char* _nodeName){
+    if(!_parentNode) return pugi::xml_node();
+    return getOrAppendNode(_parentNode, _nodeName, hashName(_nodeName));
+}
+
+pugi::xml_node WriteSession::getOrAppendNode(pugi::xml_node& _parentNode, const char* _nodeName, std::uint64_t _hash){
+    if(!_parentNode) return pugi::xml_node();
+    NameTable& table = getChildTable(_parentNode);
+    if(void* existing = table.find(_nodeName, _hash)){
+        return pugi::xml_node(static_cast<pugi::xml_node_struct*>(existing));
+    }
+
+    pugi::xml_node node = _parentNode.append_child(_nodeName);
+    if(node) table.insert(node.name(), _hash, node.internal_object());
+    return node;
+}
+
+} // namespace ofxPugiXml
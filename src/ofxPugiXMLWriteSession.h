@@ -0,0 +1,102 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+#pragma once
+
+#include "pugixml.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ofxPugiXml {
+    // Write session : duplicate-safe upserts in O(1).
+    // While a session is alive, getOrAppendAttribute() and getOrAppendNode() (and thus all setNodeAttribute() helpers)
+    // look names up in a hash table per written node, instead of scanning all existing attributes/children.
+    // It's the middle ground between the default linear checks and ofxPugiXML_NODUPLICATES_CHECKS.
+    // Usage :
+    //     {
+    //         ofxPugiXml::WriteSession session;
+    //         for(auto& p : params) ofxPugiXml::setNodeValueToAttribute(presetNode, p.name, p.value);
+    //     }
+    // Notes :
+    // - Sessions are per-thread and must be destroyed in reverse creation order (use them as scoped objects).
+    // - Don't remove or rename attributes/nodes by other means while a session is alive, the tables would go stale.
+    class WriteSession {
+    public:
+        WriteSession();
+        ~WriteSession();
+        WriteSession(const WriteSession&) = delete;
+        WriteSession& operator=(const WriteSession&) = delete;
+
+        pugi::xml_attribute getOrAppendAttribute(pugi::xml_node& _node, const char* _attrName);
+        pugi::xml_node getOrAppendNode(pugi::xml_node& _parentNode, const char* _nodeName);
+        // Same, with the name's hash already known (see hashName(), ofxPugiXml::Atom)
+        pugi::xml_attribute getOrAppendAttribute(pugi::xml_node& _node, const char* _attrName, std::uint64_t _hash);
+        pugi::xml_node getOrAppendNode(pugi::xml_node& _parentNode, const char* _nodeName, std::uint64_t _hash);
+
+        // Forgets all tables (keeps the session active)
+        void clear();
+
+        // Returns the innermost session active on this thread, or nullptr.
+        static WriteSession* getCurrent();
+
+        // Hash used for the name tables (FNV-1a, 64 bit)
+        static std::uint64_t hashName(const char* _name);
+
+    private:
+        // Open-addressing (linear probing) hash table of names.
+        // Names point to pugi's storage, which is stable as long as the attribute/node isn't removed or renamed.
+        class NameTable {
+        public:
+            // Returns the stored object or nullptr
+            void* find(const char* _name, std::uint64_t _hash) const;
+            // Inserts if not yet present (first occurrence wins, like pugi's lookups)
+            void insert(const char* _name, std::uint64_t _hash, void* _object);
+
+        private:
+            struct Slot {
+                std::uint64_t hash = 0;
+                const char* name = nullptr;
+                void* object = nullptr;
+            };
+            void grow();
+            std::vector<Slot> slots;
+            std::size_t count = 0;
+        };
+
+        NameTable& getAttributeTable(pugi::xml_node& _node);
+        NameTable& getChildTable(pugi::xml_node& _node);
+
+        std::unordered_map<pugi::xml_node_struct*, NameTable> attributeTables;
+        std::unordered_map<pugi::xml_node_struct*, NameTable> childTables;
+
+        // Consecutive writes usually target the same node
+        pugi::xml_node_struct* lastAttributeNode = nullptr;
+        NameTable* lastAttributeTable = nullptr;
+        pugi::xml_node_struct* lastChildNode = nullptr;
+        NameTable* lastChildTable = nullptr;
+
+        WriteSession* previous = nullptr;
+    };
+} // namespace ofxPugiXml
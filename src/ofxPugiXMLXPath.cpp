@@ -0,0 +1,204 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofxPugiXMLXPath.h"
+
+#ifndef PUGIXML_NO_XPATH
+
+#include <chrono>
+
+namespace ofxPugiXml {
+
+    //--------------------------------------------------------------
+    XPathVariables::Variable& XPathVariables::getOrAdd(const char* _name, pugi::xpath_value_type _type){
+        Variable* ret = nullptr;
+        for(Variable& variable : variables){
+            if(variable.name == _name){
+                ret = &variable;
+                break;
+            }
+        }
+        if(ret != nullptr && ret->type == _type) return *ret;
+
+        if(ret == nullptr){
+            variables.emplace_back();
+            ret = &variables.back();
+            ret->name = _name;
+        }
+        ret->type = _type;
+
+        // Names or types changed, rebuild the signature
+        signature.clear();
+        for(const Variable& variable : variables){
+            signature.append(variable.name);
+            signature.push_back(':');
+            signature.push_back(char('0' + variable.type));
+            signature.push_back(';');
+        }
+        return *ret;
+    }
+
+    XPathVariables& XPathVariables::set(const char* _name, double _value){
+        getOrAdd(_name, pugi::xpath_type_number).number = _value;
+        return *this;
+    }
+
+    XPathVariables& XPathVariables::set(const char* _name, bool _value){
+        getOrAdd(_name, pugi::xpath_type_boolean).boolean = _value;
+        return *this;
+    }
+
+    XPathVariables& XPathVariables::set(const char* _name, const char* _value){
+        getOrAdd(_name, pugi::xpath_type_string).string = (_value != nullptr) ? _value : "";
+        return *this;
+    }
+
+    XPathVariables& XPathVariables::set(const char* _name, const pugi::xpath_node_set& _value){
+        getOrAdd(_name, pugi::xpath_type_node_set).nodes = _value;
+        return *this;
+    }
+
+    void XPathVariables::clear(){
+        variables.clear();
+        signature.clear();
+    }
+
+    //--------------------------------------------------------------
+    XPathCache::XPathCache(){
+
+    }
+
+    XPathCache::~XPathCache(){
+
+    }
+
+    void XPathCache::clear(){
+        queries.clear();
+    }
+
+    const pugi::xpath_query* XPathCache::prepare(const char* _expression, const XPathVariables* _variables, pugi::xpath_value_type _expectedType){
+        if(_expression == nullptr) return nullptr;
+        if(_variables != nullptr && _variables->variables.empty()) _variables = nullptr;
+
+        key.assign(_expression);
+        if(_variables != nullptr){
+            key.push_back('\0');
+            key.append(_variables->signature);
+        }
+
+        Query* query = nullptr;
+        auto found = queries.find(key);
+        if(found != queries.end()){
+            query = &found->second;
+            stats.hits++;
+        }
+        else {
+            query = &queries[key];
+            const auto start = std::chrono::steady_clock::now();
+
+            if(_variables != nullptr){
+                query->variableSet.reset(new pugi::xpath_variable_set());
+                query->variables.reserve(_variables->variables.size());
+                for(const XPathVariables::Variable& variable : _variables->variables){
+                    query->variables.push_back(query->variableSet->add(variable.name.c_str(), variable.type));
+                }
+            }
+#ifndef PUGIXML_NO_EXCEPTIONS
+            try {
+#endif
+                query->query.reset(new pugi::xpath_query(_expression, query->variableSet.get()));
+                if(!(*query->query)){
+                    lastError = query->query->result().description();
+                    query->query.reset();
+                }
+#ifndef PUGIXML_NO_EXCEPTIONS
+            }
+            catch(const pugi::xpath_exception& e){
+                lastError = e.what();
+                query->query.reset();
+            }
+#endif
+            stats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if(query->query) stats.compiles++;
+            else stats.failedCompiles++;
+        }
+
+        if(!query->query) return nullptr;
+        // Evaluating with another return type throws (or returns empty results without exceptions)
+        if(_expectedType == pugi::xpath_type_node_set && query->query->return_type() != pugi::xpath_type_node_set) return nullptr;
+
+        if(_variables != nullptr){
+            for(std::size_t i = 0; i < query->variables.size(); ++i){
+                const XPathVariables::Variable& variable = _variables->variables[i];
+                pugi::xpath_variable* target = query->variables[i];
+                if(target == nullptr) continue;
+                switch(variable.type){
+                    case pugi::xpath_type_number: target->set(variable.number); break;
+                    case pugi::xpath_type_boolean: target->set(variable.boolean); break;
+                    case pugi::xpath_type_string: target->set(variable.string.c_str()); break;
+                    case pugi::xpath_type_node_set: target->set(variable.nodes); break;
+                    default: break;
+                }
+            }
+        }
+        return query->query.get();
+    }
+
+    const pugi::xpath_query* XPathCache::getQuery(const char* _expression, const XPathVariables* _variables){
+        return prepare(_expression, _variables, pugi::xpath_type_none);
+    }
+
+    pugi::xpath_node_set XPathCache::selectNodes(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables){
+        const pugi::xpath_query* query = prepare(_expression, _variables, pugi::xpath_type_node_set);
+        if(query == nullptr || !_context) return pugi::xpath_node_set();
+        return query->evaluate_node_set(_context);
+    }
+
+    pugi::xpath_node XPathCache::selectNode(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables){
+        const pugi::xpath_query* query = prepare(_expression, _variables, pugi::xpath_type_node_set);
+        if(query == nullptr || !_context) return pugi::xpath_node();
+        return query->evaluate_node(_context);
+    }
+
+    double XPathCache::evaluateNumber(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables, double _defaultValue){
+        const pugi::xpath_query* query = prepare(_expression, _variables, pugi::xpath_type_none);
+        if(query == nullptr || !_context) return _defaultValue;
+        return query->evaluate_number(_context);
+    }
+
+    std::string XPathCache::evaluateString(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables){
+        const pugi::xpath_query* query = prepare(_expression, _variables, pugi::xpath_type_none);
+        if(query == nullptr || !_context) return std::string();
+        return query->evaluate_string(_context);
+    }
+
+    bool XPathCache::evaluateBoolean(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables){
+        const pugi::xpath_query* query = prepare(_expression, _variables, pugi::xpath_type_none);
+        if(query == nullptr || !_context) return false;
+        return query->evaluate_boolean(_context);
+    }
+}
+
+#endif // PUGIXML_NO_XPATH
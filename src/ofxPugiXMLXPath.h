@@ -0,0 +1,175 @@
+// =============================================================================
+//
+// Copyright (c) 2024 Daan de Lange <https://daandelange.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+#include "pugixml.hpp"
+#include "ofxPugiXMLHelpers.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef PUGIXML_NO_XPATH
+
+namespace ofxPugiXml {
+
+    // Typed variables for XPath queries, referenced as `$name` in expressions.
+    // Changing values is cheap, queries are compiled once per set of variable names/types.
+    class XPathVariables {
+    public:
+        XPathVariables& set(const char* _name, double _value);
+        XPathVariables& set(const char* _name, float _value){ return set(_name, (double)_value); }
+        XPathVariables& set(const char* _name, int _value){ return set(_name, (double)_value); }
+        XPathVariables& set(const char* _name, unsigned int _value){ return set(_name, (double)_value); }
+        XPathVariables& set(const char* _name, bool _value);
+        XPathVariables& set(const char* _name, const char* _value);
+        XPathVariables& set(const char* _name, const std::string& _value){ return set(_name, _value.c_str()); }
+        XPathVariables& set(const char* _name, const pugi::xpath_node_set& _value);
+
+        std::size_t size() const { return variables.size(); }
+        void clear();
+
+    protected:
+        friend class XPathCache;
+
+        struct Variable {
+            std::string name;
+            pugi::xpath_value_type type = pugi::xpath_type_none;
+            double number = 0;
+            bool boolean = false;
+            std::string string;
+            pugi::xpath_node_set nodes;
+        };
+        Variable& getOrAdd(const char* _name, pugi::xpath_value_type _type);
+
+        std::vector<Variable> variables;
+        // Names and types, identifies the compiled queries that can be reused with these variables.
+        std::string signature;
+    };
+
+    // Compiled XPath query cache
+    // Compiling an expression is much more expensive than evaluating it : queries are compiled once, keyed by
+    // expression and variable signature, then reused. Compiled queries don't depend on a document, so a cache
+    // stays valid across (re)loads.
+    // Failed compiles are cached too (see getLastError()), they don't throw.
+    // Usage :
+    //     ofxPugiXml::XPathCache xpath;
+    //     glm::vec3 pos;
+    //     xpath.getValue(doc, "//object[@name='camera']/position", pos);
+    //     ofxPugiXml::XPathVariables vars;
+    //     vars.set("id", 12);
+    //     pugi::xpath_node_set layers = xpath.selectNodes(doc, "//layer[@id=$id]", &vars);
+    class XPathCache {
+    public:
+        XPathCache();
+        ~XPathCache();
+        XPathCache(const XPathCache&) = delete;
+        XPathCache& operator=(const XPathCache&) = delete;
+
+        struct Stats {
+            std::size_t hits = 0;
+            std::size_t compiles = 0;
+            std::size_t failedCompiles = 0;
+            double compileMs = 0;
+        };
+
+        // Returns the compiled query (with variables bound), or nullptr if the expression is invalid.
+        const pugi::xpath_query* getQuery(const char* _expression, const XPathVariables* _variables = nullptr);
+
+        pugi::xpath_node_set selectNodes(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables = nullptr);
+        pugi::xpath_node selectNode(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables = nullptr);
+        double evaluateNumber(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables = nullptr, double _defaultValue = 0);
+        std::string evaluateString(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables = nullptr);
+        bool evaluateBoolean(const pugi::xml_node& _context, const char* _expression, const XPathVariables* _variables = nullptr);
+
+        // Reads the first result into a helper type.
+        // Attributes and text nodes are parsed as single values, elements are read like getNodeValue()
+        // (base types) or getNodeAttributeValue() (glm vectors, ofFloatColor, arrays).
+        template<typename TYPE>
+        bool getValue(const pugi::xml_node& _context, const char* _expression, TYPE& _value, const XPathVariables* _variables = nullptr){
+            return readValue(selectNode(_context, _expression, _variables), _value);
+        }
+        // Reads all results, appended to _values. Returns false if one of them couldn't be read.
+        template<typename TYPE>
+        bool getValues(const pugi::xml_node& _context, const char* _expression, std::vector<TYPE>& _values, const XPathVariables* _variables = nullptr){
+            pugi::xpath_node_set results = selectNodes(_context, _expression, _variables);
+            bool ret = true;
+            _values.reserve(_values.size() + results.size());
+            for(const pugi::xpath_node& result : results){
+                _values.emplace_back();
+                ret &= readValue(result, _values.back());
+            }
+            return ret;
+        }
+
+        // Converts an XPath result to a helper type
+        template<typename TYPE>
+        static bool readValue(const pugi::xpath_node& _result, TYPE& _value){
+            pugi::xml_attribute attr = _result.attribute();
+            if(attr) return getAttributeValue(attr, _value);
+            pugi::xml_node node = _result.node();
+            if(!node) return false;
+            return getNodeValue(node, _value);
+        }
+        static bool readValue(const pugi::xpath_node& _result, glm::vec2& _value){ return readComposite(_result, _value); }
+        static bool readValue(const pugi::xpath_node& _result, glm::vec3& _value){ return readComposite(_result, _value); }
+        static bool readValue(const pugi::xpath_node& _result, glm::vec4& _value){ return readComposite(_result, _value); }
+        static bool readValue(const pugi::xpath_node& _result, glm::ivec2& _value){ return readComposite(_result, _value); }
+        static bool readValue(const pugi::xpath_node& _result, ofFloatColor& _value){ return readComposite(_result, _value); }
+
+        void clear();
+        std::size_t size() const { return queries.size(); }
+        const Stats& getStats() const { return stats; }
+        void resetStats(){ stats = Stats(); }
+        // Description of the last compile error
+        const std::string& getLastError() const { return lastError; }
+
+    protected:
+        // Composite types are stored as attributes of their node (see setNodeValueToAttribute)
+        template<typename TYPE>
+        static bool readComposite(const pugi::xpath_node& _result, TYPE& _value){
+            pugi::xml_node node = _result.node();
+            if(!node || _result.attribute()) return false;
+            return getNodeAttributeValue(node, "", _value);
+        }
+
+        struct Query {
+            // Declared first : the query references its variables
+            std::unique_ptr<pugi::xpath_variable_set> variableSet;
+            std::vector<pugi::xpath_variable*> variables; // in XPathVariables order
+            std::unique_ptr<pugi::xpath_query> query;
+        };
+        // Returns the compiled query with the variable values assigned, nullptr if invalid.
+        const pugi::xpath_query* prepare(const char* _expression, const XPathVariables* _variables, pugi::xpath_value_type _expectedType);
+
+        std::unordered_map<std::string, Query> queries;
+        std::string key; // reused lookup key, avoids allocating on cache hits
+        Stats stats;
+        std::string lastError;
+    };
+}
+
+#endif // PUGIXML_NO_XPATH